@@ -0,0 +1,181 @@
+// Check GainBucket against a std::set reference and time it on random FM-like updates
+#include <placement/gain_bucket.hpp>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+
+
+using Bucket = placement::backend::GainBucket<int>;
+
+bool expect(bool ok, const char* what) {
+    if (!ok)
+        std::printf("FAILED: %s\n", what);
+    return ok;
+}
+
+/*insert/add/remove/top and the walk, with gains at both limits*/
+bool checkBasics() {
+    const int max_gain = 3;
+    Bucket bucket(6, max_gain);
+    bool ok = true;
+    ok &= expect(bucket.empty() && bucket.top() == Bucket::kNil, "empty bucket has no top");
+    ok &= expect(bucket.maxGain() == -max_gain, "empty bucket max gain is the lower limit");
+
+    bucket.insert(0, -max_gain);
+    bucket.insert(1, max_gain);
+    bucket.insert(2, 0);
+    ok &= expect(bucket.size() == 3 && bucket.top() == 1 && bucket.maxGain() == max_gain,
+                 "top is the item at +max_gain");
+
+    bool thrown = false;
+    try {
+        bucket.insert(3, max_gain + 1);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    ok &= expect(thrown, "insert above +max_gain throws");
+    thrown = false;
+    try {
+        bucket.insert(3, -max_gain - 1);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    ok &= expect(thrown, "insert below -max_gain throws");
+
+    bucket.add(1, -2);  // 3 -> 1
+    ok &= expect(bucket.gain(1) == 1 && bucket.top() == 1, "add moves the item down");
+    bucket.add(0, 2);   // -3 -> -1
+    bucket.remove(1);
+    ok &= expect(!bucket.contains(1) && bucket.top() == 2 && bucket.maxGain() == 0,
+                 "remove lowers the top lazily");
+    bucket.update(0, max_gain);
+    ok &= expect(bucket.top() == 0 && bucket.maxGain() == max_gain, "update raises the top");
+
+    /*front/next walk visits every item once, highest gain first*/
+    bucket.insert(4, 0);
+    int count = 0, last_gain = max_gain;
+    for (int gain = bucket.maxGain(); gain >= -max_gain; --gain) {
+        for (int item = bucket.front(gain); item != Bucket::kNil; item = bucket.next(item)) {
+            ok &= expect(bucket.gain(item) == gain && gain <= last_gain, "walk is ordered by gain");
+            last_gain = gain;
+            count++;
+        }
+    }
+    ok &= expect(count == bucket.size() && count == 3, "walk visits every item");
+
+    bucket.remove(0);
+    bucket.remove(2);
+    bucket.remove(4);
+    ok &= expect(bucket.empty() && bucket.top() == Bucket::kNil, "bucket empties");
+    bucket.reset(6, max_gain);
+    bucket.insert(5, -max_gain);
+    ok &= expect(bucket.top() == 5 && bucket.maxGain() == -max_gain, "reset reuses the bucket");
+    return ok;
+}
+
+/*the same random operations on GainBucket and on a set of (gain, item)*/
+bool checkRandom(int num_items, int max_gain, int num_ops, unsigned seed,
+                 double& bucket_ms, size_t& num_timed, long long& checksum) {
+    std::mt19937 rng(seed);
+    std::vector<int> gain_list(num_items);
+    std::vector<char> in_list(num_items, 0);
+    std::vector<std::pair<char, std::pair<int, int>>> op_list;  // (op, (item, value))
+    op_list.reserve(num_ops);
+
+    /*fill, then FM-like traffic: +-2 updates, removes of the top and reinserts*/
+    for (int i = 0; i < num_items; ++i) {
+        op_list.push_back({'i', {i, static_cast<int>(rng() % (2*max_gain + 1)) - max_gain}});
+        in_list[i] = 1;
+        gain_list[i] = op_list.back().second.second;
+    }
+    for (int k = 0; k < num_ops; ++k) {
+        const int item = rng() % num_items;
+        const int kind = rng() % 8;
+        if (!in_list[item]) {
+            const int gain = static_cast<int>(rng() % (2*max_gain + 1)) - max_gain;
+            op_list.push_back({'i', {item, gain}});
+            in_list[item] = 1;
+            gain_list[item] = gain;
+        } else if (kind == 0) {
+            op_list.push_back({'r', {item, 0}});
+            in_list[item] = 0;
+        } else if (kind == 1) {
+            op_list.push_back({'t', {0, 0}});
+        } else {
+            const int delta = rng() & 1 ? 2 : -2;
+            if (gain_list[item] + delta < -max_gain || gain_list[item] + delta > max_gain) continue;
+            op_list.push_back({'a', {item, delta}});
+            gain_list[item] += delta;
+        }
+    }
+
+    /*reference: top is any item with the largest gain*/
+    std::set<std::pair<int, int>> reference;
+    std::vector<int> reference_gain(num_items);
+    Bucket bucket(num_items, max_gain);
+    for (const auto& [op, argument] : op_list) {
+        const auto [item, value] = argument;
+        if (op == 'i') {
+            bucket.insert(item, value);
+            reference.insert({value, item});
+            reference_gain[item] = value;
+        } else if (op == 'r') {
+            bucket.remove(item);
+            reference.erase({reference_gain[item], item});
+        } else if (op == 'a') {
+            bucket.add(item, value);
+            reference.erase({reference_gain[item], item});
+            reference_gain[item] += value;
+            reference.insert({reference_gain[item], item});
+        } else {
+            const int top = bucket.top();
+            const int expected = reference.empty() ? Bucket::kNil : reference.rbegin()->first;
+            if ((top == Bucket::kNil) != reference.empty()
+                || (top != Bucket::kNil && bucket.gain(top) != expected))
+                return expect(false, "top disagrees with the reference");
+        }
+        if (bucket.size() != static_cast<int>(reference.size()))
+            return expect(false, "size disagrees with the reference");
+    }
+
+    /*the same operations timed alone*/
+    checksum = 0;  // printed, so the top() calls stay
+    auto start = std::chrono::steady_clock::now();
+    bucket.reset(num_items, max_gain);
+    for (const auto& [op, argument] : op_list) {
+        const auto [item, value] = argument;
+        if (op == 'i') bucket.insert(item, value);
+        else if (op == 'r') bucket.remove(item);
+        else if (op == 'a') bucket.add(item, value);
+        else checksum += bucket.top();
+    }
+    bucket_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    num_timed = op_list.size();
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    const int num_items = argc > 1 ? std::max(1, std::stoi(argv[1])) : 1000000;
+    const int max_gain = argc > 2 ? std::max(1, std::stoi(argv[2])) : 16;
+    const int num_ops = argc > 3 ? std::max(0, std::stoi(argv[3])) : 4*num_items;
+    if (argc > 4) {
+        std::cout << "Usage: ./benchmark_gain_bucket [num_items] [max_gain] [num_ops]" << std::endl;
+        return 1;
+    }
+
+    if (!checkBasics())
+        return 1;
+    double bucket_ms = 0;
+    size_t num_timed = 0;
+    long long checksum = 0;
+    if (!checkRandom(1000, 4, 100000, 1, bucket_ms, num_timed, checksum)
+        || !checkRandom(num_items, max_gain, num_ops, 2, bucket_ms, num_timed, checksum))
+        return 1;
+    std::cout << "checks passed" << std::endl;
+    std::cout << "items " << num_items << " max_gain " << max_gain << " ops " << num_timed
+              << "  " << bucket_ms << " ms  (" << num_timed / bucket_ms / 1e3 << " Mops/s)  checksum " << checksum << std::endl;
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Compare the stream reader (Input) with the memory-mapped reader (MappedInput),
+// and parsing plus graph building with loading a snapshot
+#include <placement/Lab3.hpp>
+#include <chrono>
+#include <filesystem>
+
+
+template <typename Read>
+double bestOf(int repeat, Read&& read) {
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < repeat; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        read();
+        std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+        best = std::min(best, duration.count());
+    }
+    return best;
+}
+
+bool sameSystem(const placement::backend::System& a, const placement::backend::System& b) {
+    if (a.chip_width != b.chip_width || a.chip_height != b.chip_height ||
+        a.row_height != b.row_height || a.num_rows != b.num_rows ||
+        a.total_cell_area != b.total_cell_area || a.max_cell_area != b.max_cell_area ||
+        a.terminal_list.size() != b.terminal_list.size() ||
+        a.cells.size() != b.cells.size())
+        return false;
+    for (size_t i = 0; i < a.terminal_list.size(); ++i) {
+        const auto& t1 = a.terminal_list[i];
+        const auto& t2 = b.terminal_list[i];
+        if (t1.name != t2.name || t1.x != t2.x || t1.y != t2.y ||
+            t1.width != t2.width || t1.height != t2.height)
+            return false;
+    }
+    return a.cells.name_list == b.cells.name_list &&
+           a.cells.x_list == b.cells.x_list && a.cells.y_list == b.cells.y_list &&
+           a.cells.width_list == b.cells.width_list && a.cells.height_list == b.cells.height_list;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: ./benchmark_input <Input_flie> [repeat]" << std::endl;
+        return 1;
+    }
+    const int repeat = argc > 2 ? std::max(1, std::stoi(argv[2])) : 5;
+
+    std::unique_ptr<placement::backend::System> stream_ptr, mapped_ptr;
+    double stream_ms = bestOf(repeat, [&] {
+        std::ifstream in(argv[1], std::ifstream::in);
+        placement::Input input(in);
+        stream_ptr = input.readFile();
+    });
+    double mapped_ms = bestOf(repeat, [&] {
+        placement::MappedInput input(argv[1]);
+        mapped_ptr = input.readFile();
+    });
+
+    if (!stream_ptr || !mapped_ptr)
+        return 1;
+    if (!sameSystem(*stream_ptr, *mapped_ptr)) {
+        std::cout << "readers disagree on " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << "cells " << mapped_ptr->cells.size()
+              << " terminals " << mapped_ptr->terminal_list.size() << std::endl;
+    std::cout << "stream " << stream_ms << " ms" << std::endl;
+    std::cout << "mmap   " << mapped_ms << " ms  (x" << stream_ms / mapped_ms << ")" << std::endl;
+
+    /*what a snapshot saves: parsing and the overlap graph*/
+    double graph_ms = bestOf(repeat, [&] {
+        mapped_ptr->overlap_graph = placement::createOverlapGraph(mapped_ptr->cells);
+    });
+    auto snapshot_path = (std::filesystem::temp_directory_path() / "benchmark_input.plss").string();
+    if (!placement::Snapshot::write(*mapped_ptr, snapshot_path))
+        return 1;
+    std::unique_ptr<placement::backend::System> snapshot_ptr;
+    double snapshot_ms = bestOf(repeat, [&] {
+        snapshot_ptr = placement::Snapshot::read(snapshot_path);
+    });
+    std::filesystem::remove(snapshot_path);
+    if (!snapshot_ptr || !sameSystem(*mapped_ptr, *snapshot_ptr)
+        || snapshot_ptr->overlap_graph.neighbor_list != mapped_ptr->overlap_graph.neighbor_list) {
+        std::cout << "snapshot disagrees on " << argv[1] << std::endl;
+        return 1;
+    }
+    std::cout << "mmap + graph " << mapped_ms + graph_ms << " ms" << std::endl;
+    std::cout << "snapshot     " << snapshot_ms << " ms  (x"
+              << (mapped_ms + graph_ms) / snapshot_ms << ")" << std::endl;
+    return 0;
+}
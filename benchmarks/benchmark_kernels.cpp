@@ -0,0 +1,100 @@
+// Time the scalar and the AVX2 reduction kernels on the columns of a design
+#include <placement/Lab3.hpp>
+#include <placement/generator.hpp>
+#include <placement/kernels.hpp>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+
+template <typename Run>
+double bestOf(int repeat, Run&& run) {
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < repeat; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+        best = std::min(best, duration.count());
+    }
+    return best;
+}
+
+/*run one kernel under both instruction sets, print a row, false if they disagree*/
+template <typename Kernel>
+bool compare(const char* name, int repeat, Kernel&& kernel) {
+    using placement::kernels::Isa;
+    long long result[2] = {0, 0};
+    double ms[2] = {0, 0};
+    const Isa isa_list[2] = {Isa::kScalar, placement::kernels::detectIsa()};
+    for (int k = 0; k < 2; ++k) {
+        placement::kernels::setIsa(isa_list[k]);
+        ms[k] = bestOf(repeat, [&] { result[k] = kernel(); });
+    }
+    placement::kernels::setIsa(placement::kernels::detectIsa());
+    std::printf("%-14s %12.3f %12.3f %8.2fx %16lld\n", name, ms[0], ms[1],
+                ms[1] > 0 ? ms[0] / ms[1] : 0.0, result[1]);
+    if (result[0] != result[1]) {
+        std::printf("%s: scalar %lld != %s %lld\n", name, result[0],
+                    placement::kernels::isaName(isa_list[1]), result[1]);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: ./benchmark_kernels <Input_flie | --cells N> [repeat]" << std::endl;
+        return 1;
+    }
+    std::string arg = argv[1];
+    int next = 2;
+    std::unique_ptr<placement::backend::System> system_ptr;
+    if (arg == "--cells" && argc > 2) {
+        placement::GeneratorOptions options;
+        options.num_cells = std::stoi(argv[next++]);
+        system_ptr = placement::DesignGenerator(options).generate();
+    } else {
+        placement::MappedInput input(arg);
+        system_ptr = input.readFile();
+    }
+    if (!system_ptr)
+        return 1;
+    const int repeat = argc > next ? std::max(1, std::stoi(argv[next])) : 20;
+
+    /*a random partition and a random displacement stand in for the real ones*/
+    auto& cells = system_ptr->cells;
+    const int n = cells.size();
+    std::mt19937 rng(1);
+    std::vector<int> side(n);
+    for (int i = 0; i < n; ++i) {
+        side[i] = rng() & 1;
+        cells.final_x_list[i] = cells.x_list[i] + static_cast<int>(rng() % 2001) - 1000;
+        cells.final_y_list[i] = cells.y_list[i] + static_cast<int>(rng() % 201) - 100;
+    }
+    const auto graph = placement::createOverlapGraph(cells);
+
+    std::printf("cells %d edges %d isa %s\n", n, graph.numEdges(),
+                placement::kernels::isaName(placement::kernels::detectIsa()));
+    std::printf("%-14s %12s %12s %9s %16s\n", "kernel", "scalar_ms", "simd_ms", "speedup", "result");
+    bool same = true;
+    same &= compare("side_area", repeat, [&] {
+        long long left = 0, right = 0;
+        placement::kernels::sideArea(side.data(), cells.area_list.data(), n, left, right);
+        return left * 3 + right;
+    });
+    same &= compare("area_stats", repeat, [&] {
+        long long total = 0;
+        int max = 0;
+        placement::kernels::areaStats(cells.area_list.data(), n, total, max);
+        return total + max;
+    });
+    same &= compare("cut_count", repeat, [&] {
+        return placement::kernels::cutCount(graph.offset_list.data(), graph.neighbor_list.data(),
+                                            n, side.data());
+    });
+    same &= compare("displacement", repeat, [&] {
+        return placement::kernels::displacement(cells.x_list.data(), cells.y_list.data(),
+                                                cells.final_x_list.data(), cells.final_y_list.data(), n);
+    });
+    return same ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+// Time every pipeline stage on input files and on synthetic designs of growing size
+#include <placement/Lab3.hpp>
+#include <placement/generator.hpp>
+#include <filesystem>
+#include <cstdio>
+
+
+struct Options {
+    std::string partition_mode = "fm";
+    unsigned seed = 1;
+    int num_threads = 1;
+    bool keep = false;  // keep the synthetic input and result files
+};
+
+void printHeader() {
+    std::printf("%-24s %9s %9s %9s %9s %9s %9s %9s %9s %10s %9s %14s\n",
+                "design", "cells", "edges", "read_ms", "graph_ms", "part_ms", "legal_ms",
+                "out_ms", "total_ms", "kcells/s", "cut", "displacement");
+}
+
+/*read, partition, legalize and write one design, print a row of the table*/
+bool runPipeline(const std::string& design, const std::string& input_path,
+                 const std::string& output_path, const Options& options) {
+    auto& profiler = placement::Profiler::instance();
+    profiler.reset();
+
+    std::unique_ptr<placement::backend::System> data_ptr;
+    {
+        placement::ScopedTimer timer("read");
+        placement::MappedInput input(input_path);
+        data_ptr = input.readFile();
+    }
+    if (!data_ptr)
+        return false;
+    const int num_cells = data_ptr->cells.size();
+
+    std::shared_ptr<placement::backend::System> data_ptr2;
+    if (options.partition_mode == "multilevel") {
+        placement::MultilevelPartition ML(std::move(data_ptr), options.seed);
+        {
+            placement::ScopedTimer timer("graph");
+            ML.initialize(options.num_threads);
+        }
+        placement::ScopedTimer timer("partition");
+        data_ptr2 = ML.partition();
+    } else {
+        placement::GraphPartition FM(std::move(data_ptr));
+        {
+            placement::ScopedTimer timer("graph");
+            FM.initialize(options.num_threads);
+        }
+        placement::ScopedTimer timer("partition");
+        data_ptr2 = FM.FMpartition(10, options.seed, options.num_threads);
+    }
+
+    placement::LegalizationAbacus Abacus(std::move(data_ptr2));
+    std::shared_ptr<placement::backend::System> data_ptr3;
+    {
+        placement::ScopedTimer timer("legalize");
+        Abacus.initialize();
+        data_ptr3 = Abacus.placement(options.num_threads);
+    }
+    {
+        placement::ScopedTimer timer("output");
+        placement::Output output(data_ptr3);
+        if (!output.writeFile(output_path))
+            return false;
+    }
+
+    /*quality: cut size and total displacement as the verifier counts them*/
+    const auto& cells = data_ptr3->cells;
+    const long long displacement = placement::kernels::displacement(
+        cells.x_list.data(), cells.y_list.data(),
+        cells.final_x_list.data(), cells.final_y_list.data(), cells.size());
+
+    const char* phase_list[] = {"read", "graph", "partition", "legalize", "output"};
+    double total = 0;
+    for (const char* phase : phase_list)
+        total += profiler.time(phase);
+    std::printf("%-24s %9d %9lld %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f %10.1f %9d %14lld\n",
+                design.c_str(), num_cells, profiler.counter("graph_edges"),
+                profiler.time("read") * 1e3, profiler.time("graph") * 1e3,
+                profiler.time("partition") * 1e3, profiler.time("legalize") * 1e3,
+                profiler.time("output") * 1e3, total * 1e3,
+                total > 0 ? num_cells / total / 1e3 : 0.0,
+                data_ptr3->partition_cost, displacement);
+    std::fflush(stdout);
+    return true;
+}
+
+std::vector<int> parseSizes(const std::string& text) {
+    std::vector<int> size_list;
+    std::stringstream in(text);
+    for (std::string item; std::getline(in, item, ',');)
+        size_list.push_back(std::stoi(item));
+    return size_list;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: ./benchmark_pipeline [Input_flie ...] [--sizes 10,100,...,1000000]"
+                  << " [--density D] [--aspect A] [--terminals N] [--blockage B]"
+                  << " [--min-width W] [--max-width W] [--partition fm|multilevel]"
+                  << " [--seed N] [--threads N] [--keep]" << std::endl;
+        return 1;
+    }
+
+    Options options;
+    placement::GeneratorOptions generator_options;
+    std::vector<std::string> input_list;
+    std::vector<int> size_list;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) {
+            size_list = parseSizes(argv[++i]);
+        } else if (arg == "--density" && i + 1 < argc) {
+            generator_options.density = std::stod(argv[++i]);
+        } else if (arg == "--aspect" && i + 1 < argc) {
+            generator_options.aspect = std::stod(argv[++i]);
+        } else if (arg == "--terminals" && i + 1 < argc) {
+            generator_options.num_terminals = std::stoi(argv[++i]);
+        } else if (arg == "--blockage" && i + 1 < argc) {
+            generator_options.blockage = std::stod(argv[++i]);
+        } else if (arg == "--min-width" && i + 1 < argc) {
+            generator_options.min_width = std::stoi(argv[++i]);
+        } else if (arg == "--max-width" && i + 1 < argc) {
+            generator_options.max_width = std::stoi(argv[++i]);
+        } else if (arg == "--partition" && i + 1 < argc) {
+            options.partition_mode = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::stoul(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.num_threads = std::stoi(argv[++i]);
+        } else if (arg == "--keep") {
+            options.keep = true;
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cout << "unknown option: " << arg << std::endl;
+            return 1;
+        } else {
+            input_list.push_back(arg);
+        }
+    }
+
+    const auto temp_dir = std::filesystem::temp_directory_path();
+    printHeader();
+    for (const auto& input_path : input_list) {
+        auto design = std::filesystem::path(input_path).filename().string();
+        auto output_path = (temp_dir / ("result_" + design)).string();
+        if (!runPipeline(design, input_path, output_path, options))
+            return 1;
+        if (!options.keep)
+            std::filesystem::remove(output_path);
+    }
+
+    /*synthetic designs go through the same reader as the bundled cases*/
+    for (int num_cells : size_list) {
+        generator_options.num_cells = num_cells;
+        generator_options.seed = options.seed;
+        auto system_ptr = placement::DesignGenerator(generator_options).generate();
+
+        auto design = "synthetic_" + std::to_string(num_cells);
+        auto input_path = (temp_dir / (design + ".txt")).string();
+        auto output_path = (temp_dir / ("result_" + design + ".txt")).string();
+        if (!placement::DesignGenerator::writeFile(*system_ptr, input_path))
+            return 1;
+        system_ptr.reset();
+        if (!runPipeline(design, input_path, output_path, options))
+            return 1;
+        if (!options.keep) {
+            std::filesystem::remove(input_path);
+            std::filesystem::remove(output_path);
+        }
+    }
+    return 0;
+}
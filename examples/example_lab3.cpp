@@ -5,68 +5,230 @@
 
 int main(int argc, char *argv[]) {
     if (argc < 3) {
-        std::cout << "Usage: ./Lab3 <Input_flie> <Output_flie>" << std::endl;
+        std::cout << "Usage: ./Lab3 <Input_flie> <Output_flie> [--reader mmap|stream]"
+                  << " [--partition fm|multilevel] [--seed N] [--threads N]"
+                  << " [--format text|binary] [--report <json_file>] [--verify]"
+                  << " [--eco <previous_result> <delta_file>]"
+                  << " [--load-snapshot <file>] [--save-snapshot <file>]" << std::endl;
+        return 1;
+    }
+
+    /*options*/
+    std::string reader_mode = "mmap";
+    std::string partition_mode = "fm";
+    std::string output_format = "text";
+    std::string report_path;
+    bool verify = false;
+    std::string eco_result_path, eco_delta_path;
+    std::string load_snapshot_path, save_snapshot_path;
+    unsigned seed = std::random_device{}();
+    int num_threads = 1;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--reader" && i + 1 < argc) {
+            reader_mode = argv[++i];
+        } else if (arg == "--partition" && i + 1 < argc) {
+            partition_mode = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::stoul(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            num_threads = std::stoi(argv[++i]);
+        } else if (arg == "--format" && i + 1 < argc) {
+            output_format = argv[++i];
+        } else if (arg == "--report" && i + 1 < argc) {
+            report_path = argv[++i];
+        } else if (arg == "--verify") {
+            verify = true;
+        } else if (arg == "--eco" && i + 2 < argc) {
+            eco_result_path = argv[++i];
+            eco_delta_path = argv[++i];
+        } else if (arg == "--load-snapshot" && i + 1 < argc) {
+            load_snapshot_path = argv[++i];
+        } else if (arg == "--save-snapshot" && i + 1 < argc) {
+            save_snapshot_path = argv[++i];
+        } else {
+            std::cout << "unknown option: " << arg << std::endl;
+            return 1;
+        }
     }
-    std::ifstream in(argv[1], std::ifstream::in);
-    std::fstream out(argv[2], std::fstream::out);
 
     // std::chrono::high_resolution_clock::time_point start, end;
     // start = std::chrono::high_resolution_clock::now();
 
-    placement::Input input(in);
-    auto data_ptr = input.readFile();
+    auto& profiler = placement::Profiler::instance();
+    profiler.setInfo("input", argv[1]);
+    profiler.setInfo("reader", reader_mode);
+    profiler.setInfo("partition", partition_mode);
+    profiler.setInfo("seed", std::to_string(seed));
+    profiler.setInfo("threads", std::to_string(num_threads));
+
+    std::unique_ptr<placement::backend::System> data_ptr;
+    {
+        placement::ScopedTimer timer("read");
+        if (!load_snapshot_path.empty()) {
+            /*design, graph and partition as saved, the input file is not read*/
+            try {
+                data_ptr = placement::Snapshot::read(load_snapshot_path);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        } else {
+            try {
+                if (reader_mode == "stream") {
+                    std::ifstream in(argv[1], std::ifstream::in);
+                    placement::Input input(in);
+                    data_ptr = input.readFile();
+                } else {
+                    placement::MappedInput input(argv[1]);
+                    data_ptr = input.readFile();
+                }
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        }
+    }
+    if (!data_ptr)
+        return 1;
     // std::cout << "start lab3!!" <<" "<<data_ptr<< std::endl;
 
-    // std::cout << "\n------Start FM Partition--------" << std::endl;
-    placement::GraphPartition FM(std::move(data_ptr));
-    FM.initialize();
-    auto data_ptr2 = FM.FMpartition(10);
-    // std::cout << "<Partition_cost> " << data_ptr2->partition_cost << std::endl;
-    // std::cout << "------End FM Partition--------" << std::endl;
-    // std::cout << "check => " << std::endl;
-    // const auto& cell_list = data_ptr2->cell_list;
-
-    // int left_area = 0, right_area = 0;
-    // for (size_t i = 0; i < cell_list.size(); ++i) {
-    //     if (cell_list[i]->id == 0) {
-    //         left_area += data_ptr2->cell_list[i]->area;
-    //     } else {
-    //         right_area += data_ptr2->cell_list[i]->area;
-    //     }
-    // }
-    // std::cout << "left area = " << left_area
-    // << " right area = " << right_area <<" ratio = "
-    // << static_cast<double>(right_area)/static_cast<double>(data_ptr2->total_cell_area)
-    // <<" max cut cost  = " << data_ptr2->partition_cost << std::endl;
-
-    // int left_area2 = 0, right_area2 = 0;
-    // for (size_t i = 0; i < data_ptr2->left_cell_list.size(); ++i) {
-    //     left_area2 += data_ptr2->left_cell_list[i]->area;
-    // }
-
-    // for (size_t i = 0; i < data_ptr2->right_cell_list.size(); ++i) {
-    //     right_area2 += data_ptr2->right_cell_list[i]->area;
-    // }
-
-    // if (left_area2 != left_area || right_area2 != right_area) {
-    //     std::cout << "error!!" << std::endl;
-    //     fgetc(stdin);
-    // }
-
-
-    // std::cout << "\n\n ------Start Abacus Two Chips--------" << std::endl;
-    placement::LegalizationAbacus Abacus(std::move(data_ptr2));
-    Abacus.initialize();
-    auto data_ptr3 = Abacus.placement();
-    // std::cout << "------End Abacus Two Chips--------" << std::endl;
+    std::shared_ptr<placement::backend::System> data_ptr3;
+    if (!eco_result_path.empty()) {
+        /*ECO: previous result + delta, only the edited region is redone*/
+        try {
+            std::shared_ptr<placement::backend::System> system_ptr = std::move(data_ptr);
+            placement::EcoPlacement eco(system_ptr);
+            {
+                placement::ScopedTimer timer("eco_init");
+                if (!placement::Output(system_ptr).readResult(eco_result_path))
+                    return 1;
+                eco.initialize();
+            }
+            placement::ScopedTimer timer("eco");
+            data_ptr3 = eco.apply(placement::readDelta(eco_delta_path));
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    } else {
+        // std::cout << "\n------Start FM Partition--------" << std::endl;
+        std::shared_ptr<placement::backend::System> data_ptr2;
+        const bool partitioned = data_ptr->num_cells > 0 && static_cast<int>(
+            data_ptr->left_cell_list.size() + data_ptr->right_cell_list.size()) == data_ptr->num_cells;
+        if (partitioned) {
+            // loaded from a snapshot taken after the partition
+            data_ptr2 = std::move(data_ptr);
+        } else if (partition_mode == "multilevel") {
+            placement::MultilevelPartition ML(std::move(data_ptr), seed);
+            {
+                placement::ScopedTimer timer("graph");
+                ML.initialize(num_threads);
+            }
+            placement::ScopedTimer timer("partition");
+            data_ptr2 = ML.partition();
+        } else {
+            placement::GraphPartition FM(std::move(data_ptr));
+            {
+                placement::ScopedTimer timer("graph");
+                FM.initialize(num_threads);
+            }
+            placement::ScopedTimer timer("partition");
+            data_ptr2 = FM.FMpartition(10, seed, num_threads);
+        }
+        if (!save_snapshot_path.empty()) {
+            placement::ScopedTimer timer("snapshot");
+            if (!placement::Snapshot::write(*data_ptr2, save_snapshot_path))
+                return 1;
+        }
+        // std::cout << "<Partition_cost> " << data_ptr2->partition_cost << std::endl;
+        // std::cout << "------End FM Partition--------" << std::endl;
+        // std::cout << "check => " << std::endl;
+        // const auto& cell_list = data_ptr2->cell_list;
+
+        // int left_area = 0, right_area = 0;
+        // for (size_t i = 0; i < cell_list.size(); ++i) {
+        //     if (cell_list[i]->id == 0) {
+        //         left_area += data_ptr2->cell_list[i]->area;
+        //     } else {
+        //         right_area += data_ptr2->cell_list[i]->area;
+        //     }
+        // }
+        // std::cout << "left area = " << left_area
+        // << " right area = " << right_area <<" ratio = "
+        // << static_cast<double>(right_area)/static_cast<double>(data_ptr2->total_cell_area)
+        // <<" max cut cost  = " << data_ptr2->partition_cost << std::endl;
+
+        // int left_area2 = 0, right_area2 = 0;
+        // for (size_t i = 0; i < data_ptr2->left_cell_list.size(); ++i) {
+        //     left_area2 += data_ptr2->left_cell_list[i]->area;
+        // }
+
+        // for (size_t i = 0; i < data_ptr2->right_cell_list.size(); ++i) {
+        //     right_area2 += data_ptr2->right_cell_list[i]->area;
+        // }
+
+        // if (left_area2 != left_area || right_area2 != right_area) {
+        //     std::cout << "error!!" << std::endl;
+        //     fgetc(stdin);
+        // }
+
+
+        // std::cout << "\n\n ------Start Abacus Two Chips--------" << std::endl;
+        placement::LegalizationAbacus Abacus(std::move(data_ptr2));
+        {
+            placement::ScopedTimer timer("legalize_init");
+            Abacus.initialize();
+        }
+        {
+            placement::ScopedTimer timer("legalize");
+            try {
+                data_ptr3 = Abacus.placement(num_threads);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        }
+        // std::cout << "------End Abacus Two Chips--------" << std::endl;
+    }
 
     /*Timer*/
     // end = std::chrono::high_resolution_clock::now();
     // std::chrono::duration<double> duration = end - start;
 
     /*Output File*/
-    for (const auto& cell : data_ptr3->cell_list)
-       out << cell->name << " " << cell->final_x << " " << cell->final_y << " " << cell->id << std::endl;
+    bool written;
+    {
+        placement::ScopedTimer timer("output");
+        placement::Output output(data_ptr3);
+        written = output_format == "binary" ? output.writeBinary(argv[2])
+                                            : output.writeFile(argv[2]);
+    }
+    if (!written)
+        return 1;
+
+    profiler.add("cells", data_ptr3->cells.size());
+    profiler.add("partition_cost", data_ptr3->partition_cost);
+
+    /*in-process legality and quality check*/
+    bool legal = true;
+    if (verify) {
+        placement::CheckResult result;
+        {
+            placement::ScopedTimer timer("verify");
+            result = placement::Checker(*data_ptr3).run();
+        }
+        placement::Checker::print(result, std::cout);
+        profiler.add("illegal_cells", result.num_misaligned + result.num_out_of_die + result.num_bad_chip);
+        profiler.add("illegal_overlaps", result.num_cell_overlaps + result.num_terminal_overlaps);
+        profiler.add("displacement", result.displacement);
+        legal = result.legal();
+    }
+
+    if (!report_path.empty() && !profiler.writeReport(report_path))
+        return 1;
+    if (!legal)
+        return 2;
 
     // std::cout << "Time : "  << duration.count() << std::endl;
     return 0;
@@ -0,0 +1,25 @@
+// Convert a binary result of Lab3 (--format binary) to the text format the verifier reads
+#include <placement/Lab3.hpp>
+
+
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        std::cout << "Usage: ./Result2Text <Input_flie> <Binary_result> <Output_flie>" << std::endl;
+        return 1;
+    }
+
+    placement::MappedInput input(argv[1]);
+    std::shared_ptr<placement::backend::System> data_ptr = input.readFile();
+    if (!data_ptr)
+        return 1;
+
+    placement::Output output(data_ptr);
+    try {
+        if (!output.readBinary(argv[2]) || !output.writeFile(argv[3]))
+            return 1;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -4,10 +4,16 @@
 
 
 
+#include <placement/profiler.hpp>
 #include <placement/input.hpp>
+#include <placement/mapped_input.hpp>
 #include <placement/graph_partition.hpp>
+#include <placement/multilevel_partition.hpp>
 #include <placement/legalization_abacus.hpp>
 #include <placement/output.hpp>
+#include <placement/checker.hpp>
+#include <placement/eco.hpp>
+#include <placement/snapshot.hpp>
 
 
 #endif  // SRC_PLACEMENT_LAB3_HPP_
@@ -0,0 +1,110 @@
+#ifndef SRC_PLACEMENT_BLOCKAGE_HPP_
+#define SRC_PLACEMENT_BLOCKAGE_HPP_
+
+#include <placement/system.hpp>
+
+namespace placement::backend {
+
+/*Blocked x intervals of every row, built in one pass over the terminals.
+  a terminal is bucketed into the rows its y range spans (count -> prefix
+  sum -> scatter, like CsrGraph), then the intervals of each row are sorted
+  and merged, so overlapping, adjacent or unsorted terminals are all fine.
+  blocked intervals of row r are interval_list[offset_list[r] .. offset_list[r+1]).*/
+class BlockageIndex {
+ public:
+    using interval_type = std::pair<int, int>;  // [x1, x2)
+
+    BlockageIndex(const std::vector<Row>& row_list, const std::pmr::vector<Terminal>& terminal_list);
+    ~BlockageIndex() = default;
+
+    int numRows() const { return static_cast<int>(offset_list_.size()) - 1; }
+    const interval_type* begin(int row) const { return interval_list_.data() + offset_list_[row]; }
+    const interval_type* end(int row) const { return interval_list_.data() + offset_list_[row + 1]; }
+
+    /*replace the segments of every row by their free parts*/
+    void cut(std::vector<Row>& row_list) const;
+
+ private:
+    std::vector<int> offset_list_{0};
+    std::vector<interval_type> interval_list_;
+};
+
+
+BlockageIndex::BlockageIndex(const std::vector<Row>& row_list,
+                             const std::pmr::vector<Terminal>& terminal_list) {
+    const int num_rows = row_list.size();
+
+    /*rows [first, last) whose y range the terminal overlaps, rows are sorted by y*/
+    auto rowRange = [&](const Terminal& terminal) -> std::pair<int, int> {
+        const int y1 = terminal.y, y2 = terminal.y + terminal.height;
+        if (terminal.width <= 0 || terminal.height <= 0)
+            return {0, 0};
+        int first = std::upper_bound(row_list.begin(), row_list.end(), y1,
+                    [](int y, const Row& row) { return y < row.y + row.height; }) - row_list.begin();
+        int last = std::lower_bound(row_list.begin(), row_list.end(), y2,
+                   [](const Row& row, int y) { return row.y < y; }) - row_list.begin();
+        return {first, std::max(first, last)};
+    };
+
+    offset_list_.assign(num_rows + 1, 0);
+    for (const auto& terminal : terminal_list) {
+        auto [first, last] = rowRange(terminal);
+        for (int row = first; row < last; ++row)
+            offset_list_[row + 1]++;
+    }
+    for (int row = 0; row < num_rows; ++row)
+        offset_list_[row + 1] += offset_list_[row];
+
+    interval_list_.resize(offset_list_[num_rows]);
+    std::vector<int> cursor(offset_list_.begin(), offset_list_.end() - 1);
+    for (const auto& terminal : terminal_list) {
+        auto [first, last] = rowRange(terminal);
+        for (int row = first; row < last; ++row)
+            interval_list_[cursor[row]++] = {terminal.x, terminal.x + terminal.width};
+    }
+
+    /*sort and merge in place, touching intervals become one*/
+    int size = 0;
+    int row_begin = 0;
+    for (int row = 0; row < num_rows; ++row) {
+        const int row_end = offset_list_[row + 1];
+        std::sort(interval_list_.begin() + row_begin, interval_list_.begin() + row_end);
+        const int first = size;
+        for (int k = row_begin; k < row_end; ++k) {
+            const auto& interval = interval_list_[k];
+            if (size > first && interval.first <= interval_list_[size - 1].second)
+                interval_list_[size - 1].second = std::max(interval_list_[size - 1].second, interval.second);
+            else
+                interval_list_[size++] = interval;
+        }
+        row_begin = row_end;
+        offset_list_[row + 1] = size;
+    }
+    interval_list_.resize(size);
+}
+
+void BlockageIndex::cut(std::vector<Row>& row_list) const {
+    std::vector<Segment> free_list;
+    for (int row = 0; row < numRows(); ++row) {
+        if (begin(row) == end(row)) continue;
+        free_list.clear();
+        for (const auto& segment : row_list[row].segment_list) {
+            /*walk the blocked intervals across the segment*/
+            int x = segment.x1;
+            auto it = std::lower_bound(begin(row), end(row), segment.x1,
+                      [](const interval_type& interval, int x) { return interval.second <= x; });
+            for (; it != end(row) && it->first < segment.x2; ++it) {
+                if (it->first > x)
+                    free_list.push_back({x, it->first, segment.y});
+                x = std::max(x, it->second);
+            }
+            if (x < segment.x2)
+                free_list.push_back({x, segment.x2, segment.y});
+        }
+        row_list[row].segment_list.assign(free_list.begin(), free_list.end());
+    }
+}
+
+}  // namespace placement::backend
+
+#endif  // SRC_PLACEMENT_BLOCKAGE_HPP_
@@ -0,0 +1,182 @@
+#ifndef SRC_PLACEMENT_CHECKER_HPP_
+#define SRC_PLACEMENT_CHECKER_HPP_
+
+#include <placement/system.hpp>
+#include <placement/overlap_sweep.hpp>
+#include <placement/kernels.hpp>
+
+namespace placement {
+
+/*legality and quality of a placed System, the same numbers as the verifier*/
+struct CheckResult {
+    int num_misaligned = 0;  // final y not on a row
+    int num_out_of_die = 0;
+    int num_bad_chip = 0;  // chip is neither 0 nor 1
+    int num_cell_overlaps = 0;  // overlapping cell pairs on the same chip
+    int num_terminal_overlaps = 0;  // cell / terminal pairs
+    std::vector<std::string> error_list;  // the first violations in words
+
+    int cut = 0;  // overlapping input pairs split across the chips
+    long long overlap_area = 0;  // overlap area of the input placement
+    long long remaining_area = 0;  // part of it left on the same chip
+    long long displacement = 0;  // total |dx| + |dy|
+
+    bool legal() const {
+        return num_misaligned == 0 && num_out_of_die == 0 && num_bad_chip == 0
+            && num_cell_overlaps == 0 && num_terminal_overlaps == 0;
+    }
+    double remainingRatio() const {
+        return overlap_area > 0 ? static_cast<double>(remaining_area) / overlap_area : 0.0;
+    }
+    /*the verifier's cost: remaining overlap ratio times displacement*/
+    double cost() const { return remainingRatio() * displacement; }
+};
+
+/*Check final positions and chips of every cell. overlaps are found by an
+  OverlapSweep per chip with the terminals on both, never pairwise.*/
+class Checker {
+ public:
+    explicit Checker(const backend::System& system, int max_errors = 10)
+    : system_(system), max_errors_(max_errors) {}
+    ~Checker() = default;
+
+    CheckResult run();
+    static void print(const CheckResult& result, std::ostream& out);
+
+ private:
+    const backend::System& system_;
+    int max_errors_;
+
+    void checkCells(CheckResult& result);
+    void checkOverlaps(int chip, CheckResult& result);
+    void checkQuality(CheckResult& result);
+    void error(CheckResult& result, const std::string& message) {
+        if (static_cast<int>(result.error_list.size()) < max_errors_)
+            result.error_list.push_back(message);
+    }
+};
+
+
+CheckResult Checker::run() {
+    CheckResult result;
+    checkCells(result);
+    checkOverlaps(0, result);
+    checkOverlaps(1, result);
+    checkQuality(result);
+    return result;
+}
+
+void Checker::print(const CheckResult& result, std::ostream& out) {
+    for (const auto& message : result.error_list)
+        out << "  " << message << "\n";
+    out << "Misaligned: " << result.num_misaligned
+        << " Out_of_die: " << result.num_out_of_die
+        << " Bad_chip: " << result.num_bad_chip
+        << " Cell_overlaps: " << result.num_cell_overlaps
+        << " Terminal_overlaps: " << result.num_terminal_overlaps << "\n";
+    out << "Cut: " << result.cut
+        << " Overlap_Remaining_Percent: " << result.remainingRatio()
+        << " Total_Offset: " << result.displacement << "\n";
+    out << (result.legal() ? "Success !!" : "Fail !!") << " Cost: " << result.cost() << std::endl;
+}
+
+/*row alignment, die bounds and chip index of every cell*/
+void Checker::checkCells(CheckResult& result) {
+    const auto& cells = system_.cells;
+    const int first_y = system_.row_list.empty() ? 0 : system_.row_list.front().y;
+    for (int i = 0; i < cells.size(); ++i) {
+        const int x = cells.final_x_list[i], y = cells.final_y_list[i];
+        const int row = system_.row_height > 0 ? (y - first_y) / system_.row_height : -1;
+        if (row < 0 || row >= system_.num_rows || first_y + row * system_.row_height != y) {
+            result.num_misaligned++;
+            error(result, std::string(cells.name_list[i]) + " is not on a row (y = "
+                          + std::to_string(y) + ")");
+        }
+        if (x < 0 || y < 0 || x + cells.width_list[i] > system_.chip_width
+            || y + cells.height_list[i] > system_.chip_height) {
+            result.num_out_of_die++;
+            error(result, std::string(cells.name_list[i]) + " leaves the die at ("
+                          + std::to_string(x) + ", " + std::to_string(y) + ")");
+        }
+        if (cells.chip_list[i] > 1) {
+            result.num_bad_chip++;
+            error(result, std::string(cells.name_list[i]) + " is on chip "
+                          + std::to_string(cells.chip_list[i]));
+        }
+    }
+}
+
+/*cells of one chip at their final positions together with the terminals*/
+void Checker::checkOverlaps(int chip, CheckResult& result) {
+    const auto& cells = system_.cells;
+    std::vector<int> id_list;  // box -> cell, -1 - t for terminal t
+    std::vector<backend::Box> box_list;
+    for (int i = 0; i < cells.size(); ++i) {
+        if (cells.chip_list[i] != chip) continue;
+        id_list.push_back(i);
+        box_list.push_back({cells.final_x_list[i], cells.final_y_list[i],
+                            cells.final_x_list[i] + cells.width_list[i],
+                            cells.final_y_list[i] + cells.height_list[i]});
+    }
+    for (int t = 0; t < static_cast<int>(system_.terminal_list.size()); ++t) {
+        const auto& terminal = system_.terminal_list[t];
+        id_list.push_back(-1 - t);
+        box_list.push_back({terminal.x, terminal.y,
+                            terminal.x + terminal.width, terminal.y + terminal.height});
+    }
+
+    auto name = [&](int id) -> std::string {
+        return std::string(id >= 0 ? cells.name_list[id] : system_.terminal_list[-1 - id].name);
+    };
+    OverlapSweep sweep(box_list);
+    sweep.run([&](int i, int j) {
+        const int a = id_list[i], b = id_list[j];
+        if (a < 0 && b < 0) return;  // terminals may touch each other
+        if (a < 0 || b < 0)
+            result.num_terminal_overlaps++;
+        else
+            result.num_cell_overlaps++;
+        error(result, name(a) + " overlaps " + name(b) + " on chip " + std::to_string(chip));
+    });
+}
+
+/*cut and remaining overlap are measured on the input positions*/
+void Checker::checkQuality(CheckResult& result) {
+    const auto& cells = system_.cells;
+    result.displacement = kernels::displacement(cells.x_list.data(), cells.y_list.data(),
+                                                cells.final_x_list.data(), cells.final_y_list.data(),
+                                                cells.size());
+    std::vector<backend::Box> box_list(cells.size());
+    for (int i = 0; i < cells.size(); ++i) {
+        box_list[i] = {cells.x_list[i], cells.y_list[i],
+                       cells.x_list[i] + cells.width_list[i], cells.y_list[i] + cells.height_list[i]};
+    }
+
+    auto visit = [&](int i, int j) {
+        const auto& a = box_list[i];
+        const auto& b = box_list[j];
+        long long area = static_cast<long long>(std::min(a.x2, b.x2) - std::max(a.x1, b.x1))
+                       * (std::min(a.y2, b.y2) - std::max(a.y1, b.y1));
+        result.overlap_area += area;
+        if (cells.chip_list[i] == cells.chip_list[j])
+            result.remaining_area += area;
+        else
+            result.cut++;
+    };
+
+    // the partition already swept the input boxes into the overlap graph
+    const auto& graph = system_.overlap_graph;
+    if (graph.numNodes() == cells.size()) {
+        for (int v = 0; v < graph.numNodes(); ++v)
+            for (auto it = graph.begin(v); it != graph.end(v); ++it)
+                if (*it > v)
+                    visit(v, *it);
+    } else {
+        OverlapSweep sweep(box_list);
+        sweep.run(visit);
+    }
+}
+
+}  // namespace placement
+
+#endif  // SRC_PLACEMENT_CHECKER_HPP_
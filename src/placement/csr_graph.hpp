@@ -0,0 +1,149 @@
+#ifndef SRC_PLACEMENT_CSR_GRAPH_HPP_
+#define SRC_PLACEMENT_CSR_GRAPH_HPP_
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include <placement/thread_pool.hpp>
+
+namespace placement::backend {
+
+/*Undirected graph in compressed sparse row form.
+  neighbors of v are neighbor_list[offset_list[v] .. offset_list[v+1]),
+  every edge is stored once from each endpoint.*/
+struct CsrGraph {
+    std::vector<int> offset_list{0};
+    std::vector<int32_t> neighbor_list;
+    std::vector<int> weight_list;  // per stored edge, empty means unit weight
+
+    int numNodes() const { return static_cast<int>(offset_list.size()) - 1; }
+    int numEdges() const { return static_cast<int>(neighbor_list.size()) / 2; }
+    int degree(int v) const { return offset_list[v + 1] - offset_list[v]; }
+    bool isWeighted() const { return !weight_list.empty(); }
+    int weight(int k) const { return weight_list.empty() ? 1 : weight_list[k]; }
+
+    const int32_t* begin(int v) const { return neighbor_list.data() + offset_list[v]; }
+    const int32_t* end(int v) const { return neighbor_list.data() + offset_list[v + 1]; }
+
+    int maxDegree() const {
+        int max_degree = 0;
+        for (int v = 0; v < numNodes(); ++v)
+            max_degree = std::max(max_degree, degree(v));
+        return max_degree;
+    }
+
+    /*build from an edge list, pair_weight_list is optional*/
+    static CsrGraph fromPairs(int num_nodes,
+                              const std::vector<std::pair<int, int>>& pair_list,
+                              const std::vector<int>& pair_weight_list = {});
+    /*build from per-thread edge lists on pool (serial without one),
+      neighbors come out sorted, so the graph does not depend on how the
+      pairs were split*/
+    static CsrGraph fromPairLists(int num_nodes,
+                                  const std::vector<std::vector<std::pair<int, int>>>& pair_lists,
+                                  ThreadPool* pool = nullptr);
+};
+
+
+CsrGraph CsrGraph::fromPairs(int num_nodes,
+                             const std::vector<std::pair<int, int>>& pair_list,
+                             const std::vector<int>& pair_weight_list) {
+    CsrGraph graph;
+    bool weighted = !pair_weight_list.empty();
+
+    /*count -> prefix sum -> scatter*/
+    graph.offset_list.assign(num_nodes + 1, 0);
+    for (const auto& [u, v] : pair_list) {
+        graph.offset_list[u + 1]++;
+        graph.offset_list[v + 1]++;
+    }
+    for (int v = 0; v < num_nodes; ++v)
+        graph.offset_list[v + 1] += graph.offset_list[v];
+
+    graph.neighbor_list.resize(2*pair_list.size());
+    if (weighted)
+        graph.weight_list.resize(2*pair_list.size());
+    std::vector<int> cursor(graph.offset_list.begin(), graph.offset_list.end() - 1);
+    for (size_t e = 0; e < pair_list.size(); ++e) {
+        const auto& [u, v] = pair_list[e];
+        int ku = cursor[u]++;
+        int kv = cursor[v]++;
+        graph.neighbor_list[ku] = v;
+        graph.neighbor_list[kv] = u;
+        if (weighted) {
+            graph.weight_list[ku] = pair_weight_list[e];
+            graph.weight_list[kv] = pair_weight_list[e];
+        }
+    }
+    return graph;
+}
+
+CsrGraph CsrGraph::fromPairLists(int num_nodes,
+                                 const std::vector<std::vector<std::pair<int, int>>>& pair_lists,
+                                 ThreadPool* pool) {
+    auto forEach = [pool](int end, auto&& func) {
+        if (pool)
+            pool->parallelFor(0, end, func);
+        else
+            for (int i = 0; i < end; ++i) func(i);
+    };
+    const int num_lists = pair_lists.size();
+    const int num_chunks = pool ? std::max(1, std::min(num_nodes, 4*pool->size())) : 1;
+    auto chunkBegin = [&](int c) { return static_cast<long long>(num_nodes) * c / num_chunks; };
+
+    /*count: degrees from every list at once*/
+    std::unique_ptr<std::atomic<int>[]> cursor(new std::atomic<int>[num_nodes + 1]);
+    forEach(num_nodes + 1, [&](int v) { cursor[v].store(0, std::memory_order_relaxed); });
+    forEach(num_lists, [&](int l) {
+        for (const auto& [u, v] : pair_lists[l]) {
+            cursor[u].fetch_add(1, std::memory_order_relaxed);
+            cursor[v].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    /*prefix sum: chunk totals, a serial scan over the chunks, then each chunk*/
+    CsrGraph graph;
+    graph.offset_list.assign(num_nodes + 1, 0);
+    std::vector<long long> chunk_sum(num_chunks + 1, 0);
+    forEach(num_chunks, [&](int c) {
+        long long sum = 0;
+        for (long long v = chunkBegin(c); v < chunkBegin(c + 1); ++v)
+            sum += cursor[v].load(std::memory_order_relaxed);
+        chunk_sum[c + 1] = sum;
+    });
+    for (int c = 0; c < num_chunks; ++c)
+        chunk_sum[c + 1] += chunk_sum[c];
+    forEach(num_chunks, [&](int c) {
+        int offset = chunk_sum[c];
+        for (long long v = chunkBegin(c); v < chunkBegin(c + 1); ++v) {
+            const int degree = cursor[v].load(std::memory_order_relaxed);
+            graph.offset_list[v] = offset;
+            cursor[v].store(offset, std::memory_order_relaxed);
+            offset += degree;
+        }
+    });
+    graph.offset_list[num_nodes] = chunk_sum[num_chunks];
+
+    /*scatter, then sort every neighbor range*/
+    graph.neighbor_list.resize(chunk_sum[num_chunks]);
+    forEach(num_lists, [&](int l) {
+        for (const auto& [u, v] : pair_lists[l]) {
+            graph.neighbor_list[cursor[u].fetch_add(1, std::memory_order_relaxed)] = v;
+            graph.neighbor_list[cursor[v].fetch_add(1, std::memory_order_relaxed)] = u;
+        }
+    });
+    forEach(num_chunks, [&](int c) {
+        for (long long v = chunkBegin(c); v < chunkBegin(c + 1); ++v)
+            std::sort(graph.neighbor_list.begin() + graph.offset_list[v],
+                      graph.neighbor_list.begin() + graph.offset_list[v + 1]);
+    });
+    return graph;
+}
+
+}  // namespace placement::backend
+
+#endif  // SRC_PLACEMENT_CSR_GRAPH_HPP_
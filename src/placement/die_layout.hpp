@@ -0,0 +1,187 @@
+#ifndef SRC_PLACEMENT_DIE_LAYOUT_HPP_
+#define SRC_PLACEMENT_DIE_LAYOUT_HPP_
+
+#include <placement/system.hpp>
+
+namespace placement::backend {
+
+/*Immutable row geometry of a die, shared by both chips.
+  segments of row r are segment_list[offset_list[r] .. offset_list[r+1]),
+  sorted by x like the neighbors of a CsrGraph.*/
+class DieLayout {
+ public:
+    DieLayout() = default;
+    explicit DieLayout(const std::vector<Row>& row_list);
+    ~DieLayout() = default;
+
+    int numRows() const { return static_cast<int>(row_y_list_.size()); }
+    int numSegments() const { return static_cast<int>(segment_list_.size()); }
+    int rowY(int row) const { return row_y_list_[row]; }
+    int begin(int row) const { return offset_list_[row]; }
+    int end(int row) const { return offset_list_[row + 1]; }
+    const Segment& segment(int s) const { return segment_list_[s]; }
+
+    /*row whose y is the closest to y*/
+    int nearestRow(int y) const;
+    /*first segment of the row starting after x*/
+    int upperSegment(int row, int x) const;
+    int rowOf(int s) const;
+
+ private:
+    std::vector<int> row_y_list_;
+    std::vector<int> offset_list_{0};
+    std::vector<Segment> segment_list_;
+};
+
+
+/*Mutable abacus state of one chip laid over a shared DieLayout,
+  one Subrow per segment in a flat array.*/
+class ChipRows {
+ public:
+    /*row_resource_list: where the clusters of every row live, default heap if empty*/
+    ChipRows(const DieLayout& layout, const LegalizeView& cells,
+             const std::vector<std::pmr::memory_resource*>& row_resource_list = {});
+    ~ChipRows() = default;
+
+    /*try the segments of the row that may beat best_cost, nearest x first.
+      a segment costs at least its vertical plus horizontal distance.
+      return the number of trial placements*/
+    int placeRow(int row, int cell, int& best_cost, int& best_segment);
+    /*append the cell to the segment for good*/
+    void commit(int s, int cell);
+    /*cluster merges over all subrows*/
+    long long numCollapses() const;
+
+ private:
+    const DieLayout& layout_;
+    LegalizeView cells_;
+    std::vector<Subrow> subrow_list_;
+    std::vector<int> row_space_list_;  // row -> largest remain_space of its segments
+};
+
+
+DieLayout::DieLayout(const std::vector<Row>& row_list) {
+    row_y_list_.reserve(row_list.size());
+    offset_list_.reserve(row_list.size() + 1);
+    for (const auto& row : row_list) {
+        row_y_list_.push_back(row.y);
+        segment_list_.insert(segment_list_.end(),
+                             row.segment_list.begin(), row.segment_list.end());
+        offset_list_.push_back(segment_list_.size());
+    }
+}
+
+int DieLayout::nearestRow(int y) const {
+    int row = std::lower_bound(row_y_list_.begin(), row_y_list_.end(), y) - row_y_list_.begin();
+    if (row == numRows() || (row > 0 && y - row_y_list_[row - 1] < row_y_list_[row] - y))
+        --row;
+    return std::max(0, row);
+}
+
+int DieLayout::upperSegment(int row, int x) const {
+    auto first = segment_list_.begin() + begin(row);
+    auto last = segment_list_.begin() + end(row);
+    return std::upper_bound(first, last, x,
+    [](int x, const Segment& segment) { return x < segment.x1; }) - segment_list_.begin();
+}
+
+int DieLayout::rowOf(int s) const {
+    return std::upper_bound(offset_list_.begin(), offset_list_.end(), s) - offset_list_.begin() - 1;
+}
+
+
+ChipRows::ChipRows(const DieLayout& layout, const LegalizeView& cells,
+                   const std::vector<std::pmr::memory_resource*>& row_resource_list)
+: layout_(layout), cells_(cells) {
+    subrow_list_.reserve(layout.numSegments());
+    for (int row = 0; row < layout.numRows(); ++row) {
+        auto* resource = row_resource_list.empty() ? std::pmr::get_default_resource()
+                                                   : row_resource_list[row];
+        for (int s = layout.begin(row); s < layout.end(row); ++s)
+            subrow_list_.emplace_back(layout.segment(s), resource);
+    }
+
+    row_space_list_.assign(layout.numRows(), 0);
+    for (int row = 0; row < layout.numRows(); ++row)
+        for (int s = layout.begin(row); s < layout.end(row); ++s)
+            row_space_list_[row] = std::max(row_space_list_[row], subrow_list_[s].remain_space);
+}
+
+int ChipRows::placeRow(int row, int cell, int& best_cost, int& best_segment) {
+    const int x = cells_.x[cell], width = cells_.width[cell];
+    if (row_space_list_[row] < width) return 0;
+    const int first = layout_.begin(row);
+    const int last = layout_.end(row);
+    const int dy = std::abs(layout_.rowY(row) - cells_.y[cell]);
+
+    auto lowerBound = [&](int s) -> int {
+        const auto& segment = layout_.segment(s);
+        return dy + std::abs(subrow_list_[s].modifiedX(segment.x1, segment.x2, x, width) - x);
+    };
+    int num_trials = 0;
+    auto attempPlaceSubrow = [&](int s) {
+        const auto& subrow = subrow_list_[s];
+        if (subrow.remain_space < width) return;
+        num_trials++;
+        int delta_cost = subrow.trialCost(cell, cells_);
+        if (delta_cost < best_cost) {
+            best_segment = s;
+            best_cost = delta_cost;
+        }
+    };
+
+    // first segment starting after x, the one before may contain x
+    int right = layout_.upperSegment(row, x);
+    int left = right - 1;
+
+    // segments are disjoint and sorted, the distance grows away from x
+    while (left >= first || right < last) {
+        int left_bound = left >= first ? lowerBound(left) : INT_MAX;
+        int right_bound = right < last ? lowerBound(right) : INT_MAX;
+        if (std::min(left_bound, right_bound) >= best_cost)
+            break;
+        if (left_bound <= right_bound)
+            attempPlaceSubrow(left--);
+        else
+            attempPlaceSubrow(right++);
+    }
+    return num_trials;
+}
+
+void ChipRows::commit(int s, int cell) {
+    auto& subrow = subrow_list_[s];
+#ifdef PLACEMENT_CHECKED
+    const int expected_cost = subrow.cost + subrow.trialCost(cell, cells_);
+#endif
+    subrow.commit(cell, cells_);
+
+    const int row = layout_.rowOf(s);
+    row_space_list_[row] = 0;
+    for (int i = layout_.begin(row); i < layout_.end(row); ++i)
+        row_space_list_[row] = std::max(row_space_list_[row], subrow_list_[i].remain_space);
+
+#ifdef PLACEMENT_CHECKED
+    int cost = 0;
+    for (int i = 0; i < subrow.last_cluster_num; ++i) {
+        int x = subrow.cluster_list[i].xc;
+        for (int k = subrow.cluster_list[i].begin; k < subrow.cluster_list[i].end; ++k) {
+            int other = subrow.order_list[k];
+            cost += std::abs(x - cells_.x[other]) + std::abs(subrow.segment->y - cells_.y[other]);
+            x += cells_.width[other];
+        }
+    }
+    if (subrow.cost != expected_cost || cost != expected_cost)
+        throw std::logic_error("incremental displacement mismatch");
+#endif
+}
+
+long long ChipRows::numCollapses() const {
+    long long num_collapses = 0;
+    for (const auto& subrow : subrow_list_)
+        num_collapses += subrow.num_collapses;
+    return num_collapses;
+}
+
+}  // namespace placement::backend
+
+#endif  // SRC_PLACEMENT_DIE_LAYOUT_HPP_
@@ -0,0 +1,675 @@
+#ifndef SRC_PLACEMENT_ECO_HPP_
+#define SRC_PLACEMENT_ECO_HPP_
+
+#include <placement/system.hpp>
+#include <placement/die_layout.hpp>
+#include <placement/gain_bucket.hpp>
+#include <placement/graph_partition.hpp>
+#include <placement/radix_sort.hpp>
+#include <placement/legalization_abacus.hpp>
+#include <placement/profiler.hpp>
+
+namespace placement {
+
+/*one line of a delta file, '#' starts a comment line:
+    Add <name> <x> <y> <width> <height>
+    Remove <name>
+    Move <name> <x> <y>*/
+struct EcoEdit {
+    enum class Type { kAdd, kRemove, kMove };
+    Type type;
+    std::string name;
+    int x = 0, y = 0;
+    int width = 0, height = 0;
+};
+
+std::vector<EcoEdit> readDelta(const std::string& path);
+
+
+/*Incremental re-placement of a placed System after small edits.
+  The overlap graph is patched around the edited cells, FM only moves the
+  edited cells and their neighbors while the rest of the partition stays
+  fixed, and only the subrows that lose or gain a cell are legalized again
+  (Abacus over the cells of the subrow in x order). Between calls the System
+  stays placed, so apply() can be called once per edit batch.*/
+class EcoPlacement {
+ public:
+    using system_ptr_type = std::shared_ptr<backend::System>;
+
+    /*final positions and chips of system_ptr must hold a placement,
+      e.g. from LegalizationAbacus or Output::readResult*/
+    explicit EcoPlacement(system_ptr_type system_ptr)
+    : system_ptr_(system_ptr) {}
+    ~EcoPlacement() = default;
+
+    /*block the rows, build the overlap graph if missing and index the cells*/
+    void initialize();
+    /*apply the edits in order and bring the placement back to legal.
+      a bad edit throws std::invalid_argument before any edit is applied*/
+    system_ptr_type apply(const std::vector<EcoEdit>& edit_list);
+
+ private:
+    static constexpr int kNone = -1;
+
+    system_ptr_type system_ptr_{nullptr};
+    backend::DieLayout layout_;
+    std::unordered_map<std::string_view, int> id_map_;  // name -> cell
+    std::vector<std::pair<int, int>> x_order_;  // (x, cell) sorted, answers overlap queries
+    int max_width_ = 0;
+
+    /*legalization state: slot = chip * numSegments + segment*/
+    std::vector<int> slot_list_;  // cell -> slot, kNone if not placed
+    std::vector<std::vector<int>> slot_cell_list_;  // slot -> cells in (x, width, id) order
+    std::vector<int> slot_used_list_;  // slot -> total width of its cells
+    std::vector<int> slot_cost_list_;  // slot -> displacement of its cells, kNone if unknown
+    std::vector<char> dirty_list_;  // slot -> must be legalized again
+    std::vector<int> dirty_slot_list_;
+    std::vector<int> pending_list_;  // cells that were not on a segment at initialize()
+
+    int num_passes_ = 4;  // FM passes around the edits
+
+    int slotOf(int chip, int s) const { return chip * layout_.numSegments() + s; }
+    bool lessCell(int c1, int c2) const;
+    void updateOrder(const std::vector<char>& changed_list, const std::vector<char>& removed_list);
+    template <typename Visitor>
+    void queryOverlaps(int cell, Visitor&& visit) const;
+
+    void attach(int cell, int slot);
+    void detach(int cell);
+    /*Abacus over the cells of a slot (plus extra if >= 0), return the displacement*/
+    int placeSlot(int slot, int extra, bool write);
+    int slotCost(int slot);
+    int findSlot(int cell, int first_row, int last_row);
+
+    /*throw on an unknown or repeated name or a bad size, in batch order*/
+    void checkEdits(const std::vector<EcoEdit>& edit_list) const;
+    void patchGraph(const std::vector<char>& changed_list, const std::vector<int>& remap);
+    void compact(const std::vector<int>& remap);
+    std::vector<int> refine(const std::vector<int>& free_list, const std::vector<int>& new_list);
+    void legalize(std::vector<int> cell_list);
+};
+
+
+std::vector<EcoEdit> readDelta(const std::string& path) {
+    std::ifstream in(path, std::ifstream::in);
+    if (in.fail())
+        throw std::invalid_argument("cannot open delta file " + path);
+
+    std::vector<EcoEdit> edit_list;
+    std::string line, key;
+    for (int line_num = 1; std::getline(in, line); ++line_num) {
+        std::istringstream words(line);
+        if (!(words >> key) || key[0] == '#') continue;
+
+        EcoEdit edit;
+        bool ok = false;
+        if (key == "Add") {
+            edit.type = EcoEdit::Type::kAdd;
+            ok = static_cast<bool>(words >> edit.name >> edit.x >> edit.y >> edit.width >> edit.height);
+        } else if (key == "Remove") {
+            edit.type = EcoEdit::Type::kRemove;
+            ok = static_cast<bool>(words >> edit.name);
+        } else if (key == "Move") {
+            edit.type = EcoEdit::Type::kMove;
+            ok = static_cast<bool>(words >> edit.name >> edit.x >> edit.y);
+        }
+        std::string rest;
+        if (!ok || words >> rest)
+            throw std::invalid_argument("bad delta line " + std::to_string(line_num) + ": " + line);
+        edit_list.push_back(std::move(edit));
+    }
+    return edit_list;
+}
+
+
+void EcoPlacement::initialize() {
+    auto& system = *system_ptr_;
+    auto& cells = system.cells;
+    blockRows(system);
+    layout_ = backend::DieLayout(system.row_list);
+    buildOverlapGraph(system);
+
+    id_map_.clear();
+    id_map_.reserve(cells.size());
+    max_width_ = 0;
+    for (int i = 0; i < cells.size(); ++i) {
+        id_map_.emplace(cells.name_list[i], i);
+        max_width_ = std::max(max_width_, cells.width_list[i]);
+    }
+    std::vector<sort_item_type> item_list(cells.size());
+    for (int i = 0; i < cells.size(); ++i)
+        item_list[i] = {sortKey(cells.x_list[i]), i};
+    radixSort(item_list);  // stable, ties stay in id order
+    x_order_.resize(cells.size());
+    for (int i = 0; i < cells.size(); ++i)
+        x_order_[i] = {cells.x_list[item_list[i].second], item_list[i].second};
+
+    /*every cell goes to the segment that holds its final position*/
+    const int num_slots = 2 * layout_.numSegments();
+    slot_list_.assign(cells.size(), kNone);
+    slot_cell_list_.assign(num_slots, {});
+    slot_used_list_.assign(num_slots, 0);
+    slot_cost_list_.assign(num_slots, kNone);
+    dirty_list_.assign(num_slots, 0);
+    dirty_slot_list_.clear();
+    pending_list_.clear();
+    for (int i = 0; i < cells.size(); ++i) {
+        const int x = cells.final_x_list[i], y = cells.final_y_list[i];
+        const int row = layout_.numRows() > 0 ? layout_.nearestRow(y) : kNone;
+        const int s = row == kNone ? kNone : layout_.upperSegment(row, x) - 1;
+        if (cells.chip_list[i] > 1 || row == kNone || layout_.rowY(row) != y
+            || s < layout_.begin(row) || x + cells.width_list[i] > layout_.segment(s).x2) {
+            pending_list_.push_back(i);
+            continue;
+        }
+        const int slot = slotOf(cells.chip_list[i], s);
+        slot_list_[i] = slot;
+        slot_cell_list_[slot].push_back(i);
+        slot_used_list_[slot] += cells.width_list[i];
+    }
+    for (auto& cell_list : slot_cell_list_)
+        std::sort(cell_list.begin(), cell_list.end(),
+                  [&](int c1, int c2) { return lessCell(c1, c2); });
+}
+
+EcoPlacement::system_ptr_type EcoPlacement::apply(const std::vector<EcoEdit>& edit_list) {
+    auto& system = *system_ptr_;
+    auto& cells = system.cells;
+    const auto& graph = system.overlap_graph;
+    const int old_size = cells.size();
+    checkEdits(edit_list);
+
+    /*1. edit the cell table, the indices follow*/
+    std::vector<char> changed_list(old_size, 0), removed_list(old_size, 0);
+    std::vector<int> touched_list;  // old neighbors of the edited cells
+    auto findCell = [&](const std::string& name) { return id_map_.find(name)->second; };
+    auto touchNeighbors = [&](int cell) {
+        if (cell >= graph.numNodes()) return;
+        touched_list.insert(touched_list.end(), graph.begin(cell), graph.end(cell));
+    };
+    for (const auto& edit : edit_list) {
+        if (edit.type == EcoEdit::Type::kAdd) {
+            int id = cells.add(system.name_arena.intern(edit.name), edit.x, edit.y, edit.width, edit.height);
+            id_map_.emplace(cells.name_list[id], id);
+            max_width_ = std::max(max_width_, edit.width);
+            slot_list_.push_back(kNone);
+            changed_list.push_back(1);
+            removed_list.push_back(0);
+        } else if (edit.type == EcoEdit::Type::kRemove) {
+            int id = findCell(edit.name);
+            detach(id);
+            touchNeighbors(id);
+            id_map_.erase(cells.name_list[id]);
+            changed_list[id] = removed_list[id] = 1;
+        } else {
+            int id = findCell(edit.name);
+            detach(id);
+            touchNeighbors(id);
+            cells.x_list[id] = edit.x;
+            cells.y_list[id] = edit.y;
+            changed_list[id] = 1;
+        }
+    }
+
+    /*2. overlap graph and ids without the removed cells*/
+    updateOrder(changed_list, removed_list);
+    system.x_order.clear();  // stale, cellXOrder sorts again on demand
+    std::vector<int> remap(cells.size());
+    int num_cells = 0;
+    for (int i = 0; i < cells.size(); ++i)
+        remap[i] = removed_list[i] ? kNone : num_cells++;
+    patchGraph(changed_list, remap);
+    if (num_cells != cells.size())
+        compact(remap);
+
+    std::vector<int> edited_list, new_list;
+    for (int i = 0; i < static_cast<int>(remap.size()); ++i) {
+        if (remap[i] == kNone || !changed_list[i]) continue;
+        edited_list.push_back(remap[i]);
+        if (i >= old_size)
+            new_list.push_back(remap[i]);
+    }
+    for (int& cell : pending_list_)
+        cell = remap[cell];
+    pending_list_.erase(std::remove(pending_list_.begin(), pending_list_.end(), kNone),
+                        pending_list_.end());
+
+    system.num_cells = cells.size();
+    kernels::areaStats(cells.area_list.data(), cells.size(),
+                       system.total_cell_area, system.max_cell_area);
+
+    /*3. FM around the edits: edited cells, their new and old neighbors*/
+    std::vector<char> free_flag(cells.size(), 0);
+    std::vector<int> free_list;
+    auto markFree = [&](int cell) {
+        if (cell == kNone || free_flag[cell]) return;
+        free_flag[cell] = 1;
+        free_list.push_back(cell);
+    };
+    for (int cell : edited_list) {
+        markFree(cell);
+        for (auto it = system.overlap_graph.begin(cell); it != system.overlap_graph.end(cell); ++it)
+            markFree(*it);
+    }
+    for (int cell : touched_list)
+        markFree(remap[cell]);
+    std::vector<int> flipped_list = refine(free_list, new_list);
+
+    /*4. legalize the edited and flipped cells, then every subrow they touched*/
+    std::vector<int> place_list = edited_list;
+    for (int cell : flipped_list)
+        if (slot_list_[cell] != kNone) {
+            detach(cell);
+            place_list.push_back(cell);
+        }
+    place_list.insert(place_list.end(), pending_list_.begin(), pending_list_.end());
+    pending_list_.clear();
+    legalize(std::move(place_list));
+
+    /*5. chip lists and cut*/
+    system.left_cell_list.clear();
+    system.right_cell_list.clear();
+    for (int i = 0; i < cells.size(); ++i)
+        (cells.chip_list[i] == 0 ? system.left_cell_list : system.right_cell_list).push_back(i);
+    int cost = 0;
+    for (int v = 0; v < system.overlap_graph.numNodes(); ++v)
+        for (auto it = system.overlap_graph.begin(v); it != system.overlap_graph.end(v); ++it)
+            if (cells.chip_list[v] == 0 && cells.chip_list[*it] == 1)
+                cost++;
+    system.partition_cost = cost;
+
+    auto& profiler = Profiler::instance();
+    profiler.add("eco_edits", edit_list.size());
+    profiler.add("eco_free_cells", free_list.size());
+    profiler.add("eco_flipped_cells", flipped_list.size());
+    return system_ptr_;
+}
+
+
+/*******************************
+ *
+ *    Private Implemantation
+ *
+ *******************************/
+
+/*names added or removed earlier in the batch override id_map_*/
+void EcoPlacement::checkEdits(const std::vector<EcoEdit>& edit_list) const {
+    std::unordered_map<std::string_view, bool> exists;  // name -> exists after the edits so far
+    auto existing = [&](const std::string& name) {
+        auto it = exists.find(name);
+        return it != exists.end() ? it->second : id_map_.count(name) > 0;
+    };
+    for (const auto& edit : edit_list) {
+        if (edit.type == EcoEdit::Type::kAdd) {
+            if (existing(edit.name))
+                throw std::invalid_argument("cell " + edit.name + " already exists");
+            if (edit.width <= 0 || edit.height != system_ptr_->row_height)
+                throw std::invalid_argument("cell " + edit.name + " must be one row high");
+            exists[edit.name] = true;
+        } else {
+            if (!existing(edit.name))
+                throw std::invalid_argument("unknown cell " + edit.name + " in delta");
+            if (edit.type == EcoEdit::Type::kRemove)
+                exists[edit.name] = false;
+        }
+    }
+}
+
+/*the order Abacus appends cells, as LegalizationAbacus::sortCells*/
+bool EcoPlacement::lessCell(int c1, int c2) const {
+    const auto& cells = system_ptr_->cells;
+    if (cells.x_list[c1] != cells.x_list[c2])
+        return cells.x_list[c1] < cells.x_list[c2];
+    if (cells.width_list[c1] != cells.width_list[c2])
+        return cells.width_list[c1] < cells.width_list[c2];
+    return c1 < c2;
+}
+
+/*drop the edited cells from the x order and merge them back at their new x*/
+void EcoPlacement::updateOrder(const std::vector<char>& changed_list,
+                               const std::vector<char>& removed_list) {
+    const auto& cells = system_ptr_->cells;
+    x_order_.erase(std::remove_if(x_order_.begin(), x_order_.end(),
+                   [&](const std::pair<int, int>& key) { return changed_list[key.second]; }),
+                   x_order_.end());
+    const size_t middle = x_order_.size();
+    for (int cell = 0; cell < cells.size(); ++cell)
+        if (changed_list[cell] && !removed_list[cell])
+            x_order_.emplace_back(cells.x_list[cell], cell);
+    std::sort(x_order_.begin() + middle, x_order_.end());
+    std::inplace_merge(x_order_.begin(), x_order_.begin() + middle, x_order_.end());
+}
+
+/*cells overlapping the input box of cell: their x lies in (x - max_width, x + width)*/
+template <typename Visitor>
+void EcoPlacement::queryOverlaps(int cell, Visitor&& visit) const {
+    const auto& cells = system_ptr_->cells;
+    const int x1 = cells.x_list[cell], x2 = x1 + cells.width_list[cell];
+    const int y1 = cells.y_list[cell], y2 = y1 + cells.height_list[cell];
+    auto it = std::lower_bound(x_order_.begin(), x_order_.end(),
+                               std::make_pair(x1 - max_width_ + 1, INT_MIN));
+    for (; it != x_order_.end() && it->first < x2; ++it) {
+        const int other = it->second;
+        if (other == cell) continue;
+        if (it->first + cells.width_list[other] > x1 && cells.y_list[other] < y2
+            && cells.y_list[other] + cells.height_list[other] > y1)
+            visit(other);
+    }
+}
+
+/*drop the edges of edited cells, query their new ones, renumber by remap.
+  neighbor lists stay sorted*/
+void EcoPlacement::patchGraph(const std::vector<char>& changed_list, const std::vector<int>& remap) {
+    auto& graph = system_ptr_->overlap_graph;
+    const int num_cells = changed_list.size();
+    std::vector<std::pair<int, int>> pair_list;
+    for (int cell = 0; cell < num_cells; ++cell) {
+        if (!changed_list[cell] || remap[cell] == kNone) continue;
+        queryOverlaps(cell, [&](int other) {
+            // a pair of edited cells is found from both ends, keep one
+            if (!changed_list[other] || cell < other)
+                pair_list.emplace_back(remap[cell], remap[other]);
+        });
+    }
+
+    const int num_nodes = std::count_if(remap.begin(), remap.end(), [](int r) { return r != kNone; });
+    backend::CsrGraph next;
+    next.offset_list.assign(num_nodes + 1, 0);
+    auto kept = [&](int v) { return v < graph.numNodes() && !changed_list[v]; };
+    for (int v = 0; v < graph.numNodes(); ++v) {
+        if (!kept(v)) continue;
+        for (auto it = graph.begin(v); it != graph.end(v); ++it)
+            if (kept(*it))
+                next.offset_list[remap[v] + 1]++;
+    }
+    for (const auto& [u, v] : pair_list) {
+        next.offset_list[u + 1]++;
+        next.offset_list[v + 1]++;
+    }
+    for (int v = 0; v < num_nodes; ++v)
+        next.offset_list[v + 1] += next.offset_list[v];
+
+    next.neighbor_list.resize(next.offset_list[num_nodes]);
+    std::vector<int> cursor(next.offset_list.begin(), next.offset_list.end() - 1);
+    for (int v = 0; v < graph.numNodes(); ++v) {
+        if (!kept(v)) continue;
+        for (auto it = graph.begin(v); it != graph.end(v); ++it)
+            if (kept(*it))
+                next.neighbor_list[cursor[remap[v]]++] = remap[*it];
+    }
+    for (const auto& [u, v] : pair_list) {
+        next.neighbor_list[cursor[u]++] = v;
+        next.neighbor_list[cursor[v]++] = u;
+    }
+    /*remap keeps the order of the kept neighbors, only the ranges that got
+      new ones need sorting again, as CsrGraph::fromPairLists leaves them*/
+    std::vector<char> patched(num_nodes, 0);
+    for (const auto& [u, v] : pair_list)
+        patched[u] = patched[v] = 1;
+    for (int v = 0; v < num_nodes; ++v)
+        if (patched[v])
+            std::sort(next.neighbor_list.begin() + next.offset_list[v],
+                      next.neighbor_list.begin() + next.offset_list[v + 1]);
+    graph = std::move(next);
+}
+
+/*drop the removed cells from the table and renumber every index*/
+void EcoPlacement::compact(const std::vector<int>& remap) {
+    system_ptr_->cells.compact(remap);
+
+    // only the cells after the first removed one get a new id
+    const auto& cells = system_ptr_->cells;
+    const int first = std::find(remap.begin(), remap.end(), kNone) - remap.begin();
+    for (int i = first; i < cells.size(); ++i)
+        id_map_[cells.name_list[i]] = i;
+    for (auto& [x, cell] : x_order_)
+        cell = remap[cell];
+    for (auto& cell_list : slot_cell_list_)
+        for (int& cell : cell_list)
+            cell = remap[cell];
+
+    int n = 0;
+    for (int i = 0; i < static_cast<int>(remap.size()); ++i)
+        if (remap[i] != kNone)
+            slot_list_[n++] = slot_list_[i];
+    slot_list_.resize(n);
+}
+
+/*FM over free_list with every other cell fixed, new cells first take the
+  side that cuts more of their edges. return the old cells that changed side*/
+std::vector<int> EcoPlacement::refine(const std::vector<int>& free_list, const std::vector<int>& new_list) {
+    const auto& system = *system_ptr_;
+    const auto& graph = system.overlap_graph;
+    auto& side = system_ptr_->cells.chip_list;
+    const auto& area_list = system.cells.area_list;
+    std::vector<char> new_flag(side.size(), 0);
+    for (int cell : new_list)
+        new_flag[cell] = 1;
+
+    long long area[2] = {0, 0};
+    for (int i = 0; i < static_cast<int>(side.size()); ++i)
+        if (!new_flag[i])
+            area[side[i]] += area_list[i];
+    for (int cell : new_list) {
+        int count[2] = {0, 0};
+        for (auto it = graph.begin(cell); it != graph.end(cell); ++it)
+            if (!new_flag[*it])
+                count[side[*it]]++;
+        side[cell] = count[0] != count[1] ? count[0] > count[1] : area[1] < area[0];
+        area[side[cell]] += area_list[cell];
+        new_flag[cell] = 0;
+    }
+
+    const int num_free = free_list.size();
+    std::vector<int> local_list(side.size(), kNone);
+    std::vector<uint8_t> start_side(num_free);
+    int max_degree = 1;
+    for (int k = 0; k < num_free; ++k) {
+        local_list[free_list[k]] = k;
+        start_side[k] = side[free_list[k]];
+        max_degree = std::max(max_degree, graph.degree(free_list[k]));
+    }
+
+    /*the same window as GraphPartition: left area within half +- max cell area,
+      or closer to it than before the move*/
+    const double half = system.total_cell_area*0.5;
+    auto feasible = [&](int cell) {
+        const double offset = area[0] - half;
+        const double next_offset = offset + (side[cell] == 0 ? -area_list[cell] : area_list[cell]);
+        return std::abs(next_offset) <= system.max_cell_area || std::abs(next_offset) < std::abs(offset);
+    };
+    auto gainOf = [&](int cell) {
+        int gain = 0;
+        for (auto it = graph.begin(cell); it != graph.end(cell); ++it)
+            gain += side[*it] == side[cell] ? 1 : -1;
+        return gain;
+    };
+
+    backend::GainBucket<int> buckets[2];
+    std::vector<int> move_list;
+    for (int pass = 0; pass < num_passes_ && num_free > 0; ++pass) {
+        buckets[0].reset(num_free, max_degree);
+        buckets[1].reset(num_free, max_degree);
+        for (int k = 0; k < num_free; ++k)
+            buckets[side[free_list[k]]].insert(k, gainOf(free_list[k]));
+
+        move_list.clear();
+        int cut_delta = 0, best_delta = 0;
+        size_t best_len = 0;
+        while (true) {
+            /*best feasible move of either side*/
+            int best = kNone, best_gain = INT_MIN;
+            for (auto& bucket : buckets) {
+                if (bucket.empty()) continue;
+                for (int g = bucket.maxGain(); g >= -max_degree && g > best_gain; --g) {
+                    int k = bucket.front(g);
+                    for (; k != bucket.kNil && !feasible(free_list[k]); k = bucket.next(k)) {}
+                    if (k != bucket.kNil) {
+                        best = k;
+                        best_gain = g;
+                        break;
+                    }
+                }
+            }
+            if (best == kNone) break;
+
+            const int cell = free_list[best];
+            buckets[side[cell]].remove(best);
+            area[side[cell]] -= area_list[cell];
+            side[cell] = !side[cell];
+            area[side[cell]] += area_list[cell];
+            cut_delta += best_gain;
+            move_list.push_back(cell);
+            for (auto it = graph.begin(cell); it != graph.end(cell); ++it) {
+                int k = local_list[*it];
+                if (k == kNone || !buckets[side[*it]].contains(k)) continue;
+                // the neighbor now shares a side with cell or just left it
+                buckets[side[*it]].add(k, side[*it] == side[cell] ? 2 : -2);
+            }
+            // a state outside the window is never kept
+            if (cut_delta > best_delta && std::abs(area[0] - half) <= system.max_cell_area) {
+                best_delta = cut_delta;
+                best_len = move_list.size();
+            }
+        }
+
+        for (size_t m = move_list.size(); m > best_len; --m) {
+            const int cell = move_list[m - 1];
+            area[side[cell]] -= area_list[cell];
+            side[cell] = !side[cell];
+            area[side[cell]] += area_list[cell];
+        }
+        if (best_len == 0) break;
+    }
+
+    std::vector<int> flipped_list;
+    for (int k = 0; k < num_free; ++k)
+        if (side[free_list[k]] != start_side[k])
+            flipped_list.push_back(free_list[k]);
+    return flipped_list;
+}
+
+void EcoPlacement::attach(int cell, int slot) {
+    auto& cell_list = slot_cell_list_[slot];
+    cell_list.insert(std::upper_bound(cell_list.begin(), cell_list.end(), cell,
+                     [&](int c1, int c2) { return lessCell(c1, c2); }), cell);
+    slot_used_list_[slot] += system_ptr_->cells.width_list[cell];
+    slot_cost_list_[slot] = kNone;
+    slot_list_[cell] = slot;
+    if (!dirty_list_[slot]) {
+        dirty_list_[slot] = 1;
+        dirty_slot_list_.push_back(slot);
+    }
+}
+
+void EcoPlacement::detach(int cell) {
+    const int slot = slot_list_[cell];
+    if (slot == kNone) return;
+    auto& cell_list = slot_cell_list_[slot];
+    cell_list.erase(std::find(cell_list.begin(), cell_list.end(), cell));
+    slot_used_list_[slot] -= system_ptr_->cells.width_list[cell];
+    slot_cost_list_[slot] = kNone;
+    slot_list_[cell] = kNone;
+    if (!dirty_list_[slot]) {
+        dirty_list_[slot] = 1;
+        dirty_slot_list_.push_back(slot);
+    }
+}
+
+int EcoPlacement::placeSlot(int slot, int extra, bool write) {
+    auto& cells = system_ptr_->cells;
+    const backend::LegalizeView view(cells);
+    backend::Subrow subrow(layout_.segment(slot % layout_.numSegments()));
+    bool extra_placed = extra == kNone;
+    for (int cell : slot_cell_list_[slot]) {
+        if (!extra_placed && lessCell(extra, cell)) {
+            subrow.place(extra, view);
+            extra_placed = true;
+        }
+        subrow.place(cell, view);
+    }
+    if (!extra_placed)
+        subrow.place(extra, view);
+
+    int cost = 0;
+    const int y = subrow.segment->y;
+    for (int c = 0; c < subrow.last_cluster_num; ++c) {
+        const auto& cluster = subrow.cluster_list[c];
+        int x = cluster.xc;
+        for (int k = cluster.begin; k < cluster.end; ++k) {
+            const int cell = subrow.order_list[k];
+            cost += std::abs(x - cells.x_list[cell]) + std::abs(y - cells.y_list[cell]);
+            if (write) {
+                cells.final_x_list[cell] = x;
+                cells.final_y_list[cell] = y;
+            }
+            x += cells.width_list[cell];
+        }
+    }
+    return cost;
+}
+
+int EcoPlacement::slotCost(int slot) {
+    if (slot_cost_list_[slot] == kNone)
+        slot_cost_list_[slot] = placeSlot(slot, kNone, false);
+    return slot_cost_list_[slot];
+}
+
+/*cheapest segment of the cell's chip in rows [first_row, last_row),
+  rows best-first by vertical distance as in LegalizationAbacus*/
+int EcoPlacement::findSlot(int cell, int first_row, int last_row) {
+    const auto& cells = system_ptr_->cells;
+    const int chip = cells.chip_list[cell];
+    const int x = cells.x_list[cell], y = cells.y_list[cell], width = cells.width_list[cell];
+    int best_cost = INT_MAX, best_slot = kNone;
+
+    const int start_row = std::min(std::max(layout_.nearestRow(y), first_row), last_row - 1);
+    int up = start_row, down = start_row - 1;
+    while (true) {
+        int up_bound = up < last_row ? std::abs(layout_.rowY(up) - y) : INT_MAX;
+        int down_bound = down >= first_row ? std::abs(layout_.rowY(down) - y) : INT_MAX;
+        if (std::min(up_bound, down_bound) >= best_cost)
+            break;
+        const int row = up_bound <= down_bound ? up++ : down--;
+        const int dy = std::min(up_bound, down_bound);
+        for (int s = layout_.begin(row); s < layout_.end(row); ++s) {
+            const auto& segment = layout_.segment(s);
+            const int slot = slotOf(chip, s);
+            if (segment.x2 - segment.x1 - slot_used_list_[slot] < width) continue;
+            const int lower_bound = dy + std::abs(std::clamp(x, segment.x1, segment.x2 - width) - x);
+            if (lower_bound >= best_cost) continue;
+            int delta_cost = placeSlot(slot, cell, false) - slotCost(slot);
+            if (delta_cost < best_cost) {
+                best_cost = delta_cost;
+                best_slot = slot;
+            }
+        }
+    }
+    return best_slot;
+}
+
+/*place the cells one by one in x order, then rewrite every touched subrow*/
+void EcoPlacement::legalize(std::vector<int> cell_list) {
+    const auto& cells = system_ptr_->cells;
+    std::sort(cell_list.begin(), cell_list.end(), [&](int c1, int c2) { return lessCell(c1, c2); });
+    cell_list.erase(std::unique(cell_list.begin(), cell_list.end()), cell_list.end());
+    for (int cell : cell_list) {
+        detach(cell);
+        int slot = findSlot(cell, 0, layout_.numRows());
+        if (slot == kNone)
+            throw std::runtime_error("no room for cell " + std::string(cells.name_list[cell]));
+        attach(cell, slot);
+    }
+
+    for (int slot : dirty_slot_list_) {
+        slot_cost_list_[slot] = placeSlot(slot, kNone, true);
+        dirty_list_[slot] = 0;
+    }
+    Profiler::instance().add("eco_placed_cells", cell_list.size());
+    Profiler::instance().add("eco_subrows", dirty_slot_list_.size());
+    dirty_slot_list_.clear();
+}
+
+}  // namespace placement
+
+#endif  // SRC_PLACEMENT_ECO_HPP_
@@ -0,0 +1,106 @@
+#ifndef SRC_PLACEMENT_GAIN_BUCKET_HPP_
+#define SRC_PLACEMENT_GAIN_BUCKET_HPP_
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace placement::backend {
+
+/*Fiduccia Matteyses gain buckets over items 0 .. num_items-1.
+  One head per gain value in [-max_gain, max_gain], items are linked by
+  prev/next indices, so insert/remove/update are O(1). The bucket only
+  holds free items: locking an item is just remove(). The max-gain pointer
+  rises on insert and is lowered lazily by top(), O(1) amortized.*/
+template <typename GainType = int>
+class GainBucket {
+ public:
+    using gain_type = GainType;
+    static constexpr int kNil = -1;
+
+    GainBucket() = default;
+    GainBucket(int num_items, gain_type max_gain) { reset(num_items, max_gain); }
+    ~GainBucket() = default;
+
+    /*empty the buckets, storage is reused when the sizes do not grow*/
+    void reset(int num_items, gain_type max_gain) {
+        max_gain_ = max_gain;
+        head_list_.assign(2*max_gain + 1, kNil);
+        prev_list_.assign(num_items, kNil);
+        next_list_.assign(num_items, kNil);
+        gain_list_.assign(num_items, 0);
+        in_list_.assign(num_items, 0);
+        top_index_ = -1;
+        size_ = 0;
+    }
+
+    void insert(int item, gain_type gain) {
+        if (gain < -max_gain_ || gain > max_gain_)
+            throw std::out_of_range("gain out of bucket range");
+        int index = indexOf(gain);
+        gain_list_[item] = gain;
+        prev_list_[item] = kNil;
+        next_list_[item] = head_list_[index];
+        if (head_list_[index] != kNil)
+            prev_list_[head_list_[index]] = item;
+        head_list_[index] = item;
+        in_list_[item] = 1;
+        top_index_ = std::max(top_index_, index);
+        size_++;
+    }
+
+    void remove(int item) {
+        int prev = prev_list_[item];
+        int next = next_list_[item];
+        if (prev != kNil)
+            next_list_[prev] = next;
+        else
+            head_list_[indexOf(gain_list_[item])] = next;
+        if (next != kNil)
+            prev_list_[next] = prev;
+        in_list_[item] = 0;
+        size_--;
+    }
+
+    void update(int item, gain_type gain) {
+        remove(item);
+        insert(item, gain);
+    }
+
+    void add(int item, gain_type delta) { update(item, gain_list_[item] + delta); }
+
+    /*item with the largest gain, kNil if empty*/
+    int top() {
+        if (size_ == 0) return kNil;
+        while (head_list_[top_index_] == kNil)
+            top_index_--;
+        return head_list_[top_index_];
+    }
+
+    /*walk from the largest gain down: front(g) then next(item)*/
+    gain_type maxGain() { return top() == kNil ? -max_gain_ : top_index_ - max_gain_; }
+    int front(gain_type gain) const { return head_list_[indexOf(gain)]; }
+    int next(int item) const { return next_list_[item]; }
+
+    bool contains(int item) const { return in_list_[item]; }
+    gain_type gain(int item) const { return gain_list_[item]; }
+    gain_type maxGainBound() const { return max_gain_; }
+    bool empty() const { return size_ == 0; }
+    int size() const { return size_; }
+
+ private:
+    gain_type max_gain_ = 0;
+    std::vector<int> head_list_;  // gain + max_gain -> first item
+    std::vector<int> prev_list_;
+    std::vector<int> next_list_;
+    std::vector<gain_type> gain_list_;
+    std::vector<char> in_list_;
+    int top_index_ = -1;
+    int size_ = 0;
+
+    int indexOf(gain_type gain) const { return static_cast<int>(gain + max_gain_); }
+};
+
+}  // namespace placement::backend
+
+#endif  // SRC_PLACEMENT_GAIN_BUCKET_HPP_
@@ -0,0 +1,141 @@
+#ifndef SRC_PLACEMENT_GENERATOR_HPP_
+#define SRC_PLACEMENT_GENERATOR_HPP_
+
+#include <cmath>
+#include <random>
+
+#include <placement/system.hpp>
+#include <placement/kernels.hpp>
+#include <placement/output.hpp>
+
+namespace placement {
+
+/*knobs of a synthetic design*/
+struct GeneratorOptions {
+    int num_cells = 1000;
+    double density = 0.35;  // total cell area over the area of one die
+    double aspect = 1.0;  // die width over die height
+    int row_height = 100;
+    int min_width = 20;  // cell widths are uniform in [min_width, max_width]
+    int max_width = 200;
+    int num_terminals = 10;
+    double blockage = 0.05;  // terminal area over die area
+    unsigned seed = 1;
+};
+
+
+/*Random designs in the format of the bundled cases, for scaling studies.
+  cells are one row high and scattered uniformly over the die, so the
+  overlap graph grows with the density. the same options give the same design.*/
+class DesignGenerator {
+ public:
+    using system_ptr_type = std::unique_ptr<backend::System>;
+
+    explicit DesignGenerator(const GeneratorOptions& options)
+    : options_(options) {}
+    ~DesignGenerator() = default;
+
+    /*the design as Input / MappedInput would read it*/
+    system_ptr_type generate();
+    /*write the design as an input file*/
+    static bool writeFile(const backend::System& system, const std::string& path);
+
+ private:
+    GeneratorOptions options_;
+};
+
+
+DesignGenerator::system_ptr_type DesignGenerator::generate() {
+    const auto& opt = options_;
+    if (opt.num_cells < 0 || opt.density <= 0 || opt.aspect <= 0 || opt.row_height <= 0
+        || opt.min_width <= 0 || opt.max_width < opt.min_width)
+        throw std::invalid_argument("invalid generator options");
+
+    std::mt19937 rng(opt.seed);
+    auto system_ptr = std::make_unique<backend::System>();
+    auto& system = *system_ptr;
+
+    /*cell widths first, the die is sized from their area*/
+    std::uniform_int_distribution<int> width_dist(opt.min_width, opt.max_width);
+    std::vector<int> width_list(opt.num_cells);
+    long long total_area = 0;
+    for (int& width : width_list) {
+        width = width_dist(rng);
+        total_area += static_cast<long long>(width) * opt.row_height;
+    }
+
+    /*die: whole rows, wide enough for the widest cell*/
+    const double die_area = std::max(1.0, total_area / opt.density);
+    int num_rows = std::max(1, static_cast<int>(std::ceil(std::sqrt(die_area / opt.aspect)
+                                                          / opt.row_height)));
+    int chip_height = num_rows * opt.row_height;
+    int chip_width = std::max(opt.max_width, static_cast<int>(std::ceil(die_area / chip_height)));
+
+    system.chip_width = chip_width;
+    system.chip_height = chip_height;
+    system.row_height = opt.row_height;
+    system.num_rows = num_rows;
+    system.row_list.reserve(num_rows);
+    for (int i = 0; i < num_rows; ++i)
+        system.row_list.push_back({0, opt.row_height*i, chip_width, opt.row_height});
+
+    /*terminals share the blockage area, aspect in [1/2, 2]*/
+    system.num_terminals = opt.num_terminals;
+    system.terminal_list.resize(opt.num_terminals);
+    std::uniform_real_distribution<double> aspect_dist(0.5, 2.0);
+    const double terminal_area = opt.num_terminals > 0
+                               ? opt.blockage * chip_width * chip_height / opt.num_terminals : 0.0;
+    for (int i = 0; i < opt.num_terminals; ++i) {
+        auto& terminal = system.terminal_list[i];
+        const double aspect = aspect_dist(rng);
+        terminal.name = system.name_arena.intern("T" + std::to_string(i));
+        terminal.width = std::clamp(static_cast<int>(std::sqrt(terminal_area * aspect)), 1, chip_width);
+        terminal.height = std::clamp(static_cast<int>(std::sqrt(terminal_area / aspect)), 1, chip_height);
+        terminal.x = std::uniform_int_distribution<int>(0, chip_width - terminal.width)(rng);
+        terminal.y = std::uniform_int_distribution<int>(0, chip_height - terminal.height)(rng);
+    }
+
+    /*cells anywhere inside the die, not aligned to rows*/
+    system.num_cells = opt.num_cells;
+    system.cells.reserve(opt.num_cells);
+    std::uniform_int_distribution<int> y_dist(0, chip_height - opt.row_height);
+    for (int i = 0; i < opt.num_cells; ++i) {
+        const int width = width_list[i];
+        const int x = std::uniform_int_distribution<int>(0, chip_width - width)(rng);
+        const int y = y_dist(rng);
+        auto name = system.name_arena.intern("C" + std::to_string(i));
+        system.cells.add(name, x, y, width, opt.row_height);
+    }
+    kernels::areaStats(system.cells.area_list.data(), system.cells.size(),
+                       system.total_cell_area, system.max_cell_area);
+    return system_ptr;
+}
+
+bool DesignGenerator::writeFile(const backend::System& system, const std::string& path) {
+    BufferedWriter out(path);
+    if (!out.good()) {
+        std::cerr << "cannot open " << path << std::endl;
+        return false;
+    }
+
+    out.put("DieSize ").put(system.chip_width).put(' ').put(system.chip_height).put('\n');
+    out.put("DieRows ").put(system.row_height).put(' ').put(system.num_rows).put('\n');
+    out.put("Terminal ").put(static_cast<int>(system.terminal_list.size())).put('\n');
+    for (const auto& terminal : system.terminal_list) {
+        out.put(terminal.name).put(' ').put(terminal.x).put(' ').put(terminal.y).put(' ')
+           .put(terminal.width).put(' ').put(terminal.height).put('\n');
+    }
+
+    const auto& cells = system.cells;
+    out.put("NumCell ").put(cells.size()).put('\n');
+    for (int i = 0; i < cells.size(); ++i) {
+        out.put(cells.name_list[i]).put(' ').put(cells.x_list[i]).put(' ').put(cells.y_list[i]).put(' ')
+           .put(cells.width_list[i]).put(' ').put(cells.height_list[i]).put('\n');
+    }
+    out.flush();
+    return out.good();
+}
+
+}  // namespace placement
+
+#endif  // SRC_PLACEMENT_GENERATOR_HPP_
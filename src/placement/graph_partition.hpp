@@ -2,67 +2,79 @@
 #define SRC_PLACEMENT_GRAPH_PARTITION_HPP_
 
 #include <placement/system.hpp>
+#include <placement/overlap_sweep.hpp>
+#include <placement/gain_bucket.hpp>
+#include <placement/thread_pool.hpp>
+#include <placement/profiler.hpp>
+#include <placement/kernels.hpp>
+#include <placement/radix_sort.hpp>
 
 namespace placement {
 
+/*Create Graph by the overlap relationship, node i is cell i. num_threads > 1
+  sweeps x strips in parallel, the graph is the same for any num_threads*/
+backend::CsrGraph createOverlapGraph(const backend::CellTable& cells, int num_threads = 1);
+/*the same over cell ids sorted by x, on pool if there is one*/
+backend::CsrGraph createOverlapGraph(const backend::CellTable& cells, const std::vector<int>& x_order,
+                                     ThreadPool* pool);
+/*system.overlap_graph unless a snapshot brought it, over the shared cellXOrder*/
+void buildOverlapGraph(backend::System& system, int num_threads = 1);
+
+/*write chip index (0: left, 1: right) of every cell back to the system*/
+void writePartition(backend::System& system, const std::vector<int>& bit_vector, int cost);
+
 /*Graph Partition by Fiduccia Matteyses method*/
 class GraphPartition {
  public:
     using system_ptr_type = std::shared_ptr<backend::System>;
-    using cell_ptr_type = std::shared_ptr<backend::Cell>;
     explicit GraphPartition(system_ptr_type system_ptr)
     : system_ptr_(system_ptr) {}
     ~GraphPartition() = default;
 
-    void initialize();
+    void initialize(int num_threads = 1);
     system_ptr_type FMpartition(int max_iter);
+    /*independent restarts on num_threads workers, reproducible for a given seed*/
+    system_ptr_type FMpartition(int max_iter, unsigned seed, int num_threads = 1);
 
  private:
+    /*state of one FM restart, the graph and the cells are shared read-only*/
+    struct Trial {
+        std::vector<int> bit_vector;  // chip
+        backend::GainBucket<int> buckets[2];  // free cells of left(0) / right(1)
+        std::vector<char> locked_list;  // cell id -> locked in this pass
+        std::vector<int> move_list;  // moved cells in order
+        long long left_area;
+        long long right_area;
+        int cost;  // best cut of this restart
+        long long num_moves = 0;  // tried moves over all restarts
+    };
+
     system_ptr_type system_ptr_;
-    std::vector<int> bit_vector_;  // chip
-    std::vector<int> best_bit_vector_;  // chip
-    std::vector<cell_ptr_type> left_buckets_;
-    std::vector<cell_ptr_type> right_buckets_;
-    int left_area_;
-    int right_area_;
-    std::unordered_map<std::string, bool> locked_cell_list_;
+    std::vector<int> bit_vector_;  // initial chip of every cell
     int max_degree_;
-    int max_left_gain_index_ = 0;
-    int max_right_gain_index_ = 0;
-    bool current_side_ = 0;  // default: left side
-
-    void createGraph();
-    size_t calCost();
-    void getBothSideArea();
-    bool maxCutPartition(size_t& cost);
-        void initializeBuckets();
-        void initializeGain();
-            std::function<bool(cell_ptr_type, cell_ptr_type)> isInAdjacencyList
-            = [&] (const cell_ptr_type c1, const cell_ptr_type c2) {
-                for (const auto& c : c1->adjacency_list)
-                    if (c == c2) return true;
-                return false;
-            };
-            void sortBucket(const cell_ptr_type& cell, int gain, const std::string& side);
-        void initializeLockCells();
-        void updateGain();
-            void reductGain(cell_ptr_type cell, std::vector<cell_ptr_type> insert_buckets);
-            void increaseGain(cell_ptr_type cell, std::vector<cell_ptr_type> curr_buckets);
-
-
+    int min_cell_area_;  // no move changes a side's area by less
+
+    void createGraph(int num_threads);
+    void runTrial(Trial& trial, std::mt19937& rng);
+    size_t calCost(const std::vector<int>& bit_vector);
+    void getBothSideArea(Trial& trial);
+    bool maxCutPartition(Trial& trial);
+        void initializeBuckets(Trial& trial);
+        void initializeGain(Trial& trial);
+        void initializeLockCells(Trial& trial);
+        bool updateGain(Trial& trial, int& delta_cost);
 };
 
 
-void GraphPartition::initialize() {
+void GraphPartition::initialize(int num_threads) {
     /*Create Graph by the overlap relationship*/
-    createGraph();
+    createGraph(num_threads);
 
     /*initialize bit vector (Group)*/
     int num_cells = system_ptr_->num_cells;
     int mid = num_cells / 2;
     bit_vector_.resize(num_cells);
     for (int i = 0; i < num_cells; ++i) {
-        const auto& cell = system_ptr_->cell_list[i];
         if (i < mid) {
             bit_vector_[i] = 0;  // left chip idx
         } else {
@@ -70,63 +82,64 @@ void GraphPartition::initialize() {
         }
     }
 
-    max_degree_ = 0;
-    for (const auto&  cell : system_ptr_->cell_list) {
-        max_degree_ = std::max(max_degree_,
-                      static_cast<int>(cell->adjacency_list.size()));
-    }
+    max_degree_ = system_ptr_->overlap_graph.maxDegree();
+    const auto& area_list = system_ptr_->cells.area_list;
+    min_cell_area_ = area_list.empty() ? 0 : *std::min_element(area_list.begin(), area_list.end());
 }
 
 /*Fiduccia Matteyses method(F-M algorithm)*/
 GraphPartition::system_ptr_type GraphPartition::FMpartition(int max_iter) {
-    int iter = 0;
-    size_t cost = calCost();
-
-    auto init_group_list = bit_vector_;
-    while (iter < max_iter) {
-        // std::cout << "iter == " << iter << std::endl;
-
-        /*random sort*/
-        std::random_device rd;
-        std::default_random_engine rng(rd());
-        std::shuffle(bit_vector_.begin(), bit_vector_.end(), rng);
-
-        getBothSideArea();
-
-        /*max-cut partition*/
-        maxCutPartition(cost);
-        iter++;
-
-    }
+    return FMpartition(max_iter, std::random_device{}());
+}
 
-    // write data in left & right
-    const auto& cell_list = system_ptr_->cell_list;
-    const auto& num_cells = system_ptr_->num_cells;
-    system_ptr_->left_cell_list.reserve(num_cells);
-    system_ptr_->right_cell_list.reserve(num_cells);
-    system_ptr_->partition_cost = cost;
-
-    if (!best_bit_vector_.empty()) {
-        for (size_t i = 0; i < best_bit_vector_.size(); ++i) {
-            if (best_bit_vector_[i] == 0) {
-                cell_list[i]->id = 0;
-                system_ptr_->left_cell_list.push_back(cell_list[i]);
-            } else {
-                cell_list[i]->id = 1;
-                system_ptr_->right_cell_list.push_back(cell_list[i]);
+GraphPartition::system_ptr_type GraphPartition::FMpartition(int max_iter, unsigned seed,
+                                                            int num_threads) {
+    /*restart t draws its shuffle from (seed, t), workers keep their best*/
+    num_threads = std::max(1, std::min(num_threads, max_iter));
+    std::vector<std::pair<int, std::vector<int>>> best_list(num_threads);  // (trial, chip)
+    std::vector<int> best_cost_list(num_threads, -1);
+    std::vector<long long> num_moves_list(num_threads, 0);
+
+    auto work = [&](int worker) {
+        Trial trial;
+        for (int t = worker; t < max_iter; t += num_threads) {
+            std::seed_seq seq{seed, static_cast<unsigned>(t)};
+            std::mt19937 rng(seq);
+            runTrial(trial, rng);
+            if (trial.cost > best_cost_list[worker]) {
+                best_cost_list[worker] = trial.cost;
+                best_list[worker] = {t, trial.bit_vector};
             }
         }
+        num_moves_list[worker] = trial.num_moves;
+    };
+    if (num_threads == 1) {
+        work(0);
     } else {
-        for (size_t i = 0; i < init_group_list.size(); ++i) {
-            if (init_group_list[i] == 0) {
-                cell_list[i]->id = 0;
-                system_ptr_->left_cell_list.push_back(cell_list[i]);
-            } else {
-                cell_list[i]->id = 1;
-                system_ptr_->right_cell_list.push_back(cell_list[i]);
-            }
+        ThreadPool pool(num_threads);
+        pool.parallelFor(0, num_threads, work);
+    }
+
+    /*best cut, ties go to the lowest restart index*/
+    int cost = calCost(bit_vector_);
+    const std::vector<int>* best_bit_vector = &bit_vector_;
+    int best_trial = max_iter;
+    for (int w = 0; w < num_threads; ++w) {
+        if (best_cost_list[w] > cost
+            || (best_cost_list[w] == cost && best_list[w].first < best_trial)) {
+            cost = best_cost_list[w];
+            best_trial = best_list[w].first;
+            best_bit_vector = &best_list[w].second;
         }
     }
+
+    auto& profiler = Profiler::instance();
+    profiler.add("fm_restarts", max_iter);
+    for (long long num_moves : num_moves_list)
+        profiler.add("fm_moves", num_moves);
+
+    // write data in left & right
+    writePartition(*system_ptr_, *best_bit_vector, cost);
     return std::move(system_ptr_);
 }
 
@@ -137,105 +150,76 @@ GraphPartition::system_ptr_type GraphPartition::FMpartition(int max_iter) {
 /*
 /*******************************/
 
-void GraphPartition::getBothSideArea() {
-    left_area_ = 0;
-    right_area_ = 0;
-    for (int i = 0; i < bit_vector_.size(); ++i) {
-        if (bit_vector_[i] == 0) {
-            left_area_ += system_ptr_->cell_list[i]->area;
-        } else {
-            right_area_+= system_ptr_->cell_list[i]->area;
-        }
-    }
+void GraphPartition::runTrial(Trial& trial, std::mt19937& rng) {
+    /*random sort*/
+    trial.bit_vector = bit_vector_;
+    std::shuffle(trial.bit_vector.begin(), trial.bit_vector.end(), rng);
+
+    getBothSideArea(trial);
+
+    /*max-cut partition*/
+    maxCutPartition(trial);
 }
 
+void GraphPartition::getBothSideArea(Trial& trial) {
+    kernels::sideArea(trial.bit_vector.data(), system_ptr_->cells.area_list.data(),
+                      trial.bit_vector.size(), trial.left_area, trial.right_area);
+}
 
-// plz modified!!
-// Double counting of area
 
 /*Create Graph by the overlap relationship*/
-void GraphPartition::createGraph() {
-    auto isOverlapping = [] (const cell_ptr_type& c1, const cell_ptr_type& c2) -> bool {
-        if (c2->x < c1->x + c1->width && c2->x + c2->width > c1->x
-            && c2->y < c1->y + c1->height && c2->y + c2->height > c1->y)
-            return true;
-        else
-            return false;
-    };
-
-    /*Adjacency list*/
-    // please sort first!!!! this step can accelerate
-    auto cell_list = system_ptr_->cell_list;
-    std::sort(cell_list.begin(), cell_list.end(), [&](const cell_ptr_type c1, const cell_ptr_type c2){
-        return c1->x < c2->x;
-    });
-
-    for (int i = 0; i < system_ptr_->num_cells-1; ++i) {
-        for (int j = i + 1; j < system_ptr_->num_cells; ++j) {
-                if (cell_list[j]->x > cell_list[i]->x + cell_list[i]->width)
-                  break;
-                if (isOverlapping(cell_list[i], cell_list[j])) {
-                   cell_list[i]->adjacency_list.push_back(cell_list[j]);
-                   cell_list[j]->adjacency_list.push_back(cell_list[i]);
-                }
-        }
-    }
+void GraphPartition::createGraph(int num_threads) {
+    buildOverlapGraph(*system_ptr_, num_threads);
 }
 
-size_t GraphPartition::calCost() {
-    size_t cost = 0;
-    const auto& cell_list = system_ptr_->cell_list;
-    /*check cell in left(0)*/
-    for (int i = 0; i < bit_vector_.size(); ++i) {
-        if (bit_vector_[i] == 0) {
-            /*check where adjacency cells are*/
-            for (const auto& cell : cell_list[i]->adjacency_list)
-                if (bit_vector_[cell->id] == 1)
-                    cost++;
-        }
-    }
-    return cost;
+size_t GraphPartition::calCost(const std::vector<int>& bit_vector) {
+    /*edges from a cell in left(0) to one in right(1)*/
+    const auto& graph = system_ptr_->overlap_graph;
+    return kernels::cutCount(graph.offset_list.data(), graph.neighbor_list.data(),
+                             bit_vector.size(), bit_vector.data());
 }
 
-bool GraphPartition::maxCutPartition(size_t& cost) {
-    // std::cout << "hi!!1" << std::endl;
+/*one pass, trial.bit_vector ends at the best state seen*/
+bool GraphPartition::maxCutPartition(Trial& trial) {
     //  initialize the size of buckets on both side
-    initializeBuckets();
+    initializeBuckets(trial);
     //  initialize gain
-    initializeGain();
+    initializeGain(trial);
     // initialize locked cells
-    initializeLockCells();
-
-    /// Set which side to begin, to maintain balance
-    int num_zeros = 0;
-    for (bool is_cell_right : bit_vector_) {
-        if (is_cell_right)
-            num_zeros++;
-    }
-    if (num_zeros > 0 && bit_vector_.size() / num_zeros < 2)
-        current_side_ = true;
+    initializeLockCells(trial);
 
-    
+    auto& bit_vector = trial.bit_vector;
+    const double half = system_ptr_->total_cell_area*0.5;
+    auto balanced = [&] { return std::abs(trial.left_area - half) <= system_ptr_->max_cell_area; };
     int iter = 0, same = 0;
-    int best_cost = cost;
- 
-    while (iter < system_ptr_->num_cells) {
-        // std::cout << "<====================>" << std::endl;
-        // std::cout << "  -- " << iter << std::endl;
-        updateGain();
-        int temp_cost = calCost();
-
+    int temp_cost = calCost(bit_vector);  // tracked incrementally from here on
+    /*moves may only approach the window, a state outside it is never the best.
+      -1: no balanced state yet, the restart loses to any other*/
+    int best_cost = balanced() ? temp_cost : -1;
+    size_t best_len = 0;
+    trial.move_list.clear();
 
-        if (temp_cost > best_cost) {
+    while (iter < system_ptr_->num_cells) {
+        // moving a cell changes the cut size by exactly its gain
+        int delta_cost = 0;
+        if (!updateGain(trial, delta_cost))
+            break;  // every free cell would break the area window
+        temp_cost += delta_cost;
+
+#ifdef PLACEMENT_CHECKED
+        if (temp_cost != static_cast<int>(calCost(bit_vector)))
+            throw std::logic_error("incremental cut cost mismatch");
+#endif
+
+        if (!balanced()) {
+            // still walking into the window
+        } else if (temp_cost > best_cost) {
             best_cost = temp_cost;
-            best_bit_vector_ = bit_vector_;
+            best_len = trial.move_list.size();
             same = 0;
         } else {
             same++;
         }
-        // std::cout << " - temp_cost= " << temp_cost << " best_cost= " << best_cost << std::endl;
-        // std::cout << "<====================>\n" << std::endl;
-
 
         iter++;
 
@@ -243,267 +227,208 @@ bool GraphPartition::maxCutPartition(size_t& cost) {
                 break;
     }
 
-    // max_cut
-    if (best_cost > cost) {
-        cost = best_cost;
+    trial.num_moves += trial.move_list.size();
+
+    // max_cut, undo the moves after the best state
+    for (size_t m = trial.move_list.size(); m > best_len; --m) {
+        int id = trial.move_list[m - 1];
+        bit_vector[id] = !bit_vector[id];
     }
-    return true;
+    trial.cost = best_cost;
+    return best_len > 0;
 }
 
-void GraphPartition::initializeBuckets() {
-    // max_degree_ = 0;
-    // for (const auto&  cell : system_ptr_->cell_list) {
-    //     max_degree_ = std::max(max_degree_,
-    //                   static_cast<int>(cell->adjacency_list.size()));
-    // }
-    left_buckets_.clear();
-    right_buckets_.clear();
-
-    left_buckets_.reserve(2*max_degree_ + 1);
-    right_buckets_.reserve(2*max_degree_ + 1);
-    for (int i = 0; i < 2*max_degree_ + 1; ++i) {
-        left_buckets_.push_back(std::make_shared<backend::Cell>());
-        right_buckets_.push_back(std::make_shared<backend::Cell>());
-    }
+void GraphPartition::initializeBuckets(Trial& trial) {
+    const auto& num_cells = system_ptr_->num_cells;
+    trial.buckets[0].reset(num_cells, max_degree_);
+    trial.buckets[1].reset(num_cells, max_degree_);
 }
 
 // calculating the initial gain for each cell
-void GraphPartition::initializeGain() {
-    // std::cout <<"initializeGain" << std::endl;
-    // isInAdjacencyList
+void GraphPartition::initializeGain(Trial& trial) {
     int gain;
     const auto& num_cells =  system_ptr_->num_cells;
-    const auto& cell_list = system_ptr_->cell_list;
+    const auto& graph = system_ptr_->overlap_graph;
+    const auto& bit_vector = trial.bit_vector;
     for (int i = 0; i < num_cells; ++i) {
         gain = 0;
-        for (const auto& adjacency_cell : cell_list[i]->adjacency_list) {
-            int index = adjacency_cell->id;
-            if (bit_vector_[i] == bit_vector_[index])
+        for (auto it = graph.begin(i); it != graph.end(i); ++it) {
+            int index = *it;
+            if (bit_vector[i] == bit_vector[index])
                 gain++;
             else
                 gain--;
         }
-        // fgetc(stdin);
-        //  std::cout <<"initializeGain3" << std::endl;
-
-        if (bit_vector_[i] == 0) {
-            sortBucket(cell_list[i], gain, "left");
-        } else {
-            sortBucket(cell_list[i], gain, "right");
-        }
-    }
-
-    // for (int i = 0; i < right_buckets_.size(); ++i) {
-    //     std::cout << right_buckets_[i]->gain  << " " << left_buckets_[i]->gain << std::endl;
-    // }
-
-    // fgetc(stdin);
-
-    // std::cout <<"initializeGain2" << std::endl;
-}
-
-void GraphPartition::sortBucket(const cell_ptr_type& cell, int gain, const std::string& side) {
-    int* max_gain_idx = nullptr;
-    int index = 0;
-
-    if (side == "left") {
-        max_gain_idx = &max_left_gain_index_;
-    } else if (side == "right") {
-        max_gain_idx = &max_right_gain_index_;
+        trial.buckets[bit_vector[i]].insert(i, gain);
     }
-
-    if (gain != 0) {
-        index = max_degree_ + gain;
-        *max_gain_idx = std::max(index, *max_gain_idx);
-    } else {
-        index = max_degree_;
-        *max_gain_idx = std::max(index, *max_gain_idx);
-    }
-
-
-    cell_ptr_type cell2 = nullptr;
-    if (side == "left") {
-        cell2 = left_buckets_[index];
-    } else if (side == "right") {
-        cell2 = right_buckets_[index];
-    }
-
-    // set gain and gain link list
-    auto temp = cell2->next;
-    cell2->next = cell;
-    cell2->next->gain = gain;
-    cell2->next->next = temp;
-
-    // std::cout << cell2->next->gain << " " << cell2->next->name << std::endl;
-    // fgetc(stdin);
 }
 
-void GraphPartition::initializeLockCells() {
-    locked_cell_list_.reserve(system_ptr_->num_cells);
-    for (const auto& cell : system_ptr_->cell_list)
-        locked_cell_list_[cell->name] = false;
+void GraphPartition::initializeLockCells(Trial& trial) {
+    trial.locked_list.assign(system_ptr_->num_cells, 0);
 }
 
-void GraphPartition::updateGain() {
-    cell_ptr_type max_gain_cell = nullptr;
-    std::vector<cell_ptr_type> cur_buckets, insert_buckets;
-    int *cur_area, *insert_area;
-    int max_gain_index;
-
-    /*left*/
-    if (current_side_ == 0) {
-        cur_buckets = left_buckets_;
-        insert_buckets = right_buckets_;
-        max_gain_index = max_left_gain_index_;
-        cur_area = &left_area_;
-        insert_area = &right_area_;
-    } else {
-        /*right*/
-        cur_buckets = right_buckets_;
-        insert_buckets = left_buckets_;
-        max_gain_index = max_right_gain_index_;
-        cur_area = &right_area_;
-        insert_area = &left_area_;
-    }
-
-    bool found = false;
-    int i = 0;
-    /*search */
-    while (!found) {
-        cell_ptr_type cell_ptr = cur_buckets[max_gain_index - i];
+/*move the best cell of either side that keeps the area window, cells that
+  would break it are skipped. return false if no free cell can move*/
+bool GraphPartition::updateGain(Trial& trial, int& delta_cost) {
+    const auto& area_list = system_ptr_->cells.area_list;
+    auto& bit_vector = trial.bit_vector;
+    const double half = system_ptr_->total_cell_area*0.5;
+    const double window = system_ptr_->max_cell_area;
+    /*inside the window, or closer to it: a random start is rarely balanced.
+      if the smallest cell may not leave a side, no cell may*/
+    auto feasible = [&](int side, int area) {
+        const double offset = trial.left_area - half;
+        const double next_offset = side == 0 ? offset - area : offset + area;
+        return std::abs(next_offset) <= window || std::abs(next_offset) < std::abs(offset);
+    };
 
-        while (cell_ptr) {
-            if (!cell_ptr->name.empty() && !locked_cell_list_[cell_ptr->name]) {
-                max_gain_cell = cell_ptr;
-                found = true;
+    /*best feasible move, highest gain first, the left side wins ties*/
+    int max_gain_id = backend::GainBucket<int>::kNil;
+    int max_gain = INT_MIN;
+    for (int side = 0; side < 2; ++side) {
+        auto& bucket = trial.buckets[side];
+        if (bucket.empty() || !feasible(side, min_cell_area_)) continue;
+        for (int gain = bucket.maxGain(); gain >= -max_degree_ && gain > max_gain; --gain) {
+            int id = bucket.front(gain);
+            for (; id != bucket.kNil && !feasible(side, area_list[id]); id = bucket.next(id)) {}
+            if (id != bucket.kNil) {
+                max_gain_id = id;
+                max_gain = gain;
                 break;
             }
-            // link list
-            cell_ptr = cell_ptr->next;
         }
-        ++i;
-        if (i >= max_degree_)
-            break;
     }
-
-    // 1. checking balance by flipping sides
-    if (!max_gain_cell) {
-        current_side_ = !current_side_;
-        return;
-    }
-
-    // 1. checking check area balance by flipping
-    *cur_area -= max_gain_cell->area;
-    *insert_area += max_gain_cell->area;
-
-    double upper_limit = system_ptr_->total_cell_area*0.5 + system_ptr_->max_cell_area;
-    double lower_limt = system_ptr_->total_cell_area*0.5 - system_ptr_->max_cell_area;
-
-    if (lower_limt <= 0)
-        lower_limt = system_ptr_->total_cell_area*0.5 - system_ptr_->max_cell_area;
-
-    if (static_cast<double>(*cur_area) < lower_limt
-        || static_cast<double>(*cur_area) > upper_limit) {
-        current_side_ = !current_side_;
-        *cur_area += max_gain_cell->area;
-        *insert_area -= max_gain_cell->area;
-        return;
-    }
-
+    if (max_gain_id == backend::GainBucket<int>::kNil)
+        return false;
 
     // change max_gain_cell side
-    bit_vector_[max_gain_cell->id] = !bit_vector_[max_gain_cell->id];
+    const int side = bit_vector[max_gain_id];
+    const int max_gain_area = area_list[max_gain_id];
+    trial.left_area += side == 0 ? -max_gain_area : max_gain_area;
+    trial.right_area += side == 0 ? max_gain_area : -max_gain_area;
+    delta_cost = max_gain;
+    bit_vector[max_gain_id] = !side;
+    trial.move_list.push_back(max_gain_id);
 
-    // insert
     //  Lock cell
-    locked_cell_list_[max_gain_cell->name] = true;
-
-    for (auto& cell : max_gain_cell->adjacency_list) {
-        if (!locked_cell_list_[cell->name]) {
-            if (bit_vector_[cell->id] == current_side_) {
-                reductGain(cell, cur_buckets);
-            } else {
-                increaseGain(cell, insert_buckets);
-            }
+    trial.buckets[side].remove(max_gain_id);
+    trial.locked_list[max_gain_id] = 1;
+
+    const auto& graph = system_ptr_->overlap_graph;
+    for (auto it = graph.begin(max_gain_id); it != graph.end(max_gain_id); ++it) {
+        int id = *it;
+        if (trial.locked_list[id]) continue;
+        if (bit_vector[id] == side) {
+            trial.buckets[side].add(id, -2);  // no longer cut by this edge
+        } else {
+            trial.buckets[!side].add(id, 2);  // now cut by this edge
         }
     }
-
-    // fgetc(stdin);
-
-    current_side_ = !current_side_;
-    return;
+    return true;
 }
 
-void GraphPartition::reductGain(cell_ptr_type cell,
-std::vector<cell_ptr_type> insert_buckets) {
-    int* max_gain_ptr = nullptr;
-    if (current_side_) {
-        max_gain_ptr = &max_left_gain_index_;
-    } else {
-        max_gain_ptr = &max_right_gain_index_;
-    }
-
-    //  Remove cell
-    auto remove_ptr = insert_buckets[max_degree_ + cell->gain];
 
-    // std::cout << *max_gain_ptr<<" "<< cell->name<< " "<< cell->gain <<" " << remove_ptr->name<< std::endl;
+backend::CsrGraph createOverlapGraph(const backend::CellTable& cells, int num_threads) {
+    std::unique_ptr<ThreadPool> pool;
+    if (num_threads > 1)
+        pool = std::make_unique<ThreadPool>(num_threads);
+    std::vector<sort_item_type> item_list(cells.size());
+    for (int i = 0; i < cells.size(); ++i)
+        item_list[i] = {sortKey(cells.x_list[i]), i};
+    radixSort(item_list, pool.get());
+    std::vector<int> x_order(item_list.size());
+    for (size_t i = 0; i < item_list.size(); ++i)
+        x_order[i] = item_list[i].second;
+    return createOverlapGraph(cells, x_order, pool.get());
+}
 
-    while (remove_ptr) {
-        auto prev = remove_ptr;
-        remove_ptr = remove_ptr->next;
-        // Remove link list
-        if (remove_ptr == cell) {
-            prev->next = cell->next;
-            cell->next = nullptr;
-            break;
-        }
+backend::CsrGraph createOverlapGraph(const backend::CellTable& cells, const std::vector<int>& x_order,
+                                     ThreadPool* pool) {
+    const int num_cells = cells.size();
+    // the strips below read x_order[0]
+    if (num_cells == 0)
+        return backend::CsrGraph();
+    std::vector<backend::Box> box_list(num_cells);
+    int max_width = 0;
+    for (int i = 0; i < num_cells; ++i) {
+        box_list[i] = {cells.x_list[i], cells.y_list[i],
+                       cells.x_list[i] + cells.width_list[i], cells.y_list[i] + cells.height_list[i]};
+        max_width = std::max(max_width, cells.width_list[i]);
     }
 
-    // Add cell
-    auto prev_idx = insert_buckets[max_degree_ + cell->gain - 2];
-    auto temp = prev_idx->next;
-    prev_idx->next = cell;
-    if (insert_buckets[max_degree_ + cell->gain]->next == nullptr && *max_gain_ptr == max_degree_ + cell->gain)
-        *max_gain_ptr -= 1;
-    cell->gain -= 2;
-    prev_idx->next->next = temp;
-
+    /*strips start at x1 quantiles of the x order*/
+    const int num_strips = pool ? std::min(num_cells / 1024 + 1, 4*pool->size()) : 1;
+    auto firstAt = [&](long long x) {
+        return std::lower_bound(x_order.begin(), x_order.end(), x,
+               [&](int cell, long long x) { return box_list[cell].x1 < x; }) - x_order.begin();
+    };
+    std::vector<int> strip_begin(num_strips + 1, num_cells);
+    for (int k = 0; k < num_strips; ++k)
+        strip_begin[k] = firstAt(box_list[x_order[static_cast<long long>(num_cells) * k / num_strips]].x1);
+
+    /*a strip owns the pairs whose later box starts in it. it also sweeps
+      the boxes that start before it and reach into it, pairs of two such
+      boxes belong to an earlier strip*/
+    std::vector<std::vector<std::pair<int, int>>> pair_lists(num_strips);
+    auto sweepStrip = [&](int k) {
+        const int first = strip_begin[k], last = strip_begin[k + 1];
+        if (first == last) return;
+        const int x = box_list[x_order[first]].x1;
+        std::vector<int> id_list;
+        for (int p = firstAt(static_cast<long long>(x) - max_width); p < first; ++p)
+            if (box_list[x_order[p]].x2 > x)
+                id_list.push_back(x_order[p]);
+        const int num_carried = id_list.size();
+        id_list.insert(id_list.end(), x_order.begin() + first, x_order.begin() + last);
+
+        std::vector<backend::Box> strip_box_list(id_list.size());
+        for (size_t i = 0; i < id_list.size(); ++i)
+            strip_box_list[i] = box_list[id_list[i]];
+        auto& pair_list = pair_lists[k];
+        OverlapSweep sweep(strip_box_list);
+        sweep.run([&](int i, int j) {
+            if (i >= num_carried || j >= num_carried)
+                pair_list.emplace_back(id_list[i], id_list[j]);
+        });
+    };
+    if (pool)
+        pool->parallelFor(0, num_strips, sweepStrip);
+    else
+        sweepStrip(0);
+
+    /*Adjacency list (CSR)*/
+    auto graph = backend::CsrGraph::fromPairLists(num_cells, pair_lists, pool);
+    Profiler::instance().add("graph_edges", graph.numEdges());
+    return graph;
 }
 
-void GraphPartition::increaseGain(cell_ptr_type cell,
-std::vector<cell_ptr_type> curr_buckets) {
-    int* max_gain_ptr = nullptr;
-    if (current_side_) {
-        max_gain_ptr = &max_left_gain_index_;
-    } else {
-        max_gain_ptr = &max_right_gain_index_;
-    }
+void buildOverlapGraph(backend::System& system, int num_threads) {
+    // kept from a snapshot
+    if (system.overlap_graph.numNodes() == system.cells.size())
+        return;
+    std::unique_ptr<ThreadPool> pool;
+    if (num_threads > 1)
+        pool = std::make_unique<ThreadPool>(num_threads);
+    system.overlap_graph = createOverlapGraph(system.cells, cellXOrder(system, pool.get()), pool.get());
+}
 
-    //  Remove cell
-    cell_ptr_type remove_ptr = curr_buckets[max_degree_ + cell->gain];
-
-    // std::cout << *max_gain_ptr<<" "<< cell->name<< " "<< cell->gain <<" " << remove_ptr->name<< std::endl;
-    while (remove_ptr) {
-        auto prev = remove_ptr;
-        remove_ptr = remove_ptr->next;
-        if (remove_ptr == cell) {  // Remove
-            prev->next = cell->next;
-            cell->next = nullptr;
-            break;
-        }
+void writePartition(backend::System& system, const std::vector<int>& bit_vector, int cost) {
+    auto& chip_list = system.cells.chip_list;
+    system.left_cell_list.clear();
+    system.right_cell_list.clear();
+    system.left_cell_list.reserve(system.num_cells);
+    system.right_cell_list.reserve(system.num_cells);
+    system.partition_cost = cost;
+
+    for (size_t i = 0; i < bit_vector.size(); ++i) {
+        chip_list[i] = bit_vector[i] != 0;
+        if (bit_vector[i] == 0)
+            system.left_cell_list.push_back(i);
+        else
+            system.right_cell_list.push_back(i);
     }
-
-    // Add cell
-    auto next_idx = curr_buckets[max_degree_ + cell->gain + 2];
-    auto temp = next_idx->next;
-    next_idx->next = cell;
-    cell->gain += 2;
-    *max_gain_ptr = std::max(*max_gain_ptr, max_degree_ + cell->gain);
-    next_idx->next->next = temp;
-
 }
 
-
 }  // namespace placement
 
 #endif  // SRC_PLACEMENT_GRAPH_PARTITION_HPP_
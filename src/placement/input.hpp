@@ -3,6 +3,7 @@
 
 
 #include <placement/system.hpp>
+#include <placement/kernels.hpp>
 
 namespace placement {
 
@@ -30,7 +31,7 @@ class Input {
 };
 
 Input::system_ptr_type Input::readFile() {
-    std::string key;
+    std::string key, name;
 
     while (in_ >> key) {
         if (key == "DieSize") {
@@ -65,10 +66,10 @@ Input::system_ptr_type Input::readFile() {
             system_ptr_->terminal_list.resize(num_terminals);
             // std::cout << key << " " << system_ptr_->num_terminals << std::endl;
             for (int i = 0; i < num_terminals; ++i) {
-                auto terminal_ptr = std::make_shared<backend::Terminal>();
-                in_ >> terminal_ptr->name >> terminal_ptr->x >>
-                terminal_ptr->y >> terminal_ptr->width >> terminal_ptr->height;
-                system_ptr_->terminal_list[i] = terminal_ptr;
+                auto& terminal = system_ptr_->terminal_list[i];
+                in_ >> name >> terminal.x >>
+                terminal.y >> terminal.width >> terminal.height;
+                terminal.name = system_ptr_->name_arena.intern(name);
 
                 // std::cout << system_ptr_->terminal_list[i]->name << " " << system_ptr_->terminal_list[i]->x <<
                 // " " << system_ptr_->terminal_list[i]->y << " " << system_ptr_->terminal_list[i]->width <<" "
@@ -78,27 +79,17 @@ Input::system_ptr_type Input::readFile() {
             int num_cells;
             in_ >> num_cells;
             system_ptr_->num_cells = num_cells;
-            system_ptr_->cell_list.resize(num_cells);
-            system_ptr_->total_cell_area = 0;
-            system_ptr_->max_cell_area = 0;
+            system_ptr_->cells.reserve(num_cells);
 
             // std::cout << key << " " << system_ptr_->num_cells << std::endl;
             for (int i = 0; i < num_cells; ++i) {
-                auto cell_ptr = std::make_shared<backend::Cell>();
-                in_ >> cell_ptr->name >> cell_ptr->x >>
-                cell_ptr->y >> cell_ptr->width >> cell_ptr->height;
-                system_ptr_->cell_list[i] = cell_ptr;
-                cell_ptr->id = i;
-                cell_ptr->area = cell_ptr->width*cell_ptr->height;
-                system_ptr_->total_cell_area += cell_ptr->area;
-                system_ptr_->max_cell_area = std::max(system_ptr_->max_cell_area, cell_ptr->area);
-
-                // std::cout << cell_ptr->name << " " << cell_ptr->x <<
-                // " " << cell_ptr->y << " " << cell_ptr->width <<" "
-                // << cell_ptr->height <<" " << " id = " << cell_ptr->id 
-                // <<" max_cell_area = "<< system_ptr_->max_cell_area 
-                // << " total_cell_area = "<<system_ptr_->total_cell_area<< std::endl;
+                int x, y, width, height;
+                in_ >> name >> x >> y >> width >> height;
+                system_ptr_->cells.add(system_ptr_->name_arena.intern(name), x, y, width, height);
             }
+            const auto& area_list = system_ptr_->cells.area_list;
+            kernels::areaStats(area_list.data(), area_list.size(),
+                               system_ptr_->total_cell_area, system_ptr_->max_cell_area);
         }
     }
     in_.close();
@@ -0,0 +1,290 @@
+#ifndef SRC_PLACEMENT_KERNELS_HPP_
+#define SRC_PLACEMENT_KERNELS_HPP_
+
+#include <atomic>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PLACEMENT_KERNELS_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace placement::kernels {
+
+/*Reductions over the struct-of-arrays cell columns. every kernel has a
+  scalar and, on x86 with GCC/Clang, an AVX2 version compiled through a
+  target attribute, so the build needs no -mavx2. the dispatched entry
+  points pick AVX2 once the CPU reports it. results are exact and equal
+  for both versions.*/
+enum class Isa { kScalar, kAvx2 };
+
+/*best instruction set of this CPU*/
+Isa detectIsa();
+/*the one the dispatched kernels use, benchmarks can force kScalar*/
+Isa activeIsa();
+void setIsa(Isa isa);
+const char* isaName(Isa isa);
+
+/*area of the cells with side 0 (left) and side 1 (right), side is 0 or 1*/
+void sideArea(const int* side, const int* area, int n, long long& left, long long& right);
+/*edges from a side-0 node to a side-1 node of a CSR graph with n nodes*/
+long long cutCount(const int* offset, const int* neighbor, int n, const int* side);
+/*sum of |final_x - x| + |final_y - y|*/
+long long displacement(const int* x, const int* y, const int* final_x, const int* final_y, int n);
+/*total and maximum, max is 0 for n == 0*/
+void areaStats(const int* area, int n, long long& total, int& max);
+
+namespace scalar {
+void sideArea(const int* side, const int* area, int n, long long& left, long long& right);
+long long cutCount(const int* offset, const int* neighbor, int n, const int* side);
+long long displacement(const int* x, const int* y, const int* final_x, const int* final_y, int n);
+void areaStats(const int* area, int n, long long& total, int& max);
+}  // namespace scalar
+
+#ifdef PLACEMENT_KERNELS_AVX2
+namespace avx2 {
+void sideArea(const int* side, const int* area, int n, long long& left, long long& right);
+long long cutCount(const int* offset, const int* neighbor, int n, const int* side);
+long long displacement(const int* x, const int* y, const int* final_x, const int* final_y, int n);
+void areaStats(const int* area, int n, long long& total, int& max);
+}  // namespace avx2
+#endif
+
+
+/*******************************
+ *
+ *    Scalar
+ *
+ *******************************/
+
+void scalar::sideArea(const int* side, const int* area, int n, long long& left, long long& right) {
+    long long total = 0, right_sum = 0;
+    for (int i = 0; i < n; ++i) {
+        total += area[i];
+        right_sum += side[i] ? area[i] : 0;
+    }
+    left = total - right_sum;
+    right = right_sum;
+}
+
+long long scalar::cutCount(const int* offset, const int* neighbor, int n, const int* side) {
+    long long cut = 0;
+    for (int i = 0; i < n; ++i) {
+        if (side[i] != 0) continue;
+        for (int k = offset[i]; k < offset[i + 1]; ++k)
+            cut += side[neighbor[k]];
+    }
+    return cut;
+}
+
+long long scalar::displacement(const int* x, const int* y, const int* final_x, const int* final_y,
+                               int n) {
+    long long sum = 0;
+    for (int i = 0; i < n; ++i)
+        sum += std::abs(final_x[i] - x[i]) + std::abs(final_y[i] - y[i]);
+    return sum;
+}
+
+void scalar::areaStats(const int* area, int n, long long& total, int& max) {
+    total = 0;
+    max = 0;
+    for (int i = 0; i < n; ++i) {
+        total += area[i];
+        max = std::max(max, area[i]);
+    }
+}
+
+
+/*******************************
+ *
+ *    AVX2
+ *
+ *******************************/
+
+#ifdef PLACEMENT_KERNELS_AVX2
+namespace avx2 {
+
+/*eight int32 lanes added into four int64 lanes*/
+__attribute__((target("avx2")))
+__m256i widenAdd(__m256i sum, __m256i value) {
+    sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(value)));
+    return _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(value, 1)));
+}
+
+__attribute__((target("avx2")))
+long long sum64(__m256i sum) {
+    alignas(32) long long lane[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lane), sum);
+    return lane[0] + lane[1] + lane[2] + lane[3];
+}
+
+__attribute__((target("avx2")))
+int max32(__m256i value) {
+    alignas(32) int lane[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lane), value);
+    return *std::max_element(lane, lane + 8);
+}
+
+__attribute__((target("avx2")))
+void sideArea(const int* side, const int* area, int n, long long& left, long long& right) {
+    __m256i total = _mm256_setzero_si256(), right_sum = _mm256_setzero_si256();
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(area + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(side + i));
+        __m256i mask = _mm256_sub_epi32(zero, s);  // side 1 -> all ones
+        total = widenAdd(total, a);
+        right_sum = widenAdd(right_sum, _mm256_and_si256(mask, a));
+    }
+    long long total_area = sum64(total), right_area = sum64(right_sum);
+    for (; i < n; ++i) {
+        total_area += area[i];
+        right_area += side[i] ? area[i] : 0;
+    }
+    left = total_area - right_area;
+    right = right_area;
+}
+
+/*eight nodes at a time, one neighbor column per step (ELL order): the
+  graph is sparse, so gathering along a node's own list would be mostly
+  tail. nodes on side 1 are masked off before any gather.*/
+__attribute__((target("avx2")))
+long long cutCount(const int* offset, const int* neighbor, int n, const int* side) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i cut = zero;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i begin = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offset + i));
+        __m256i end = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offset + i + 1));
+        __m256i own = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(side + i));
+        __m256i left = _mm256_cmpeq_epi32(own, zero);
+        __m256i degree = _mm256_and_si256(left, _mm256_sub_epi32(end, begin));
+        const int max_degree = max32(degree);
+        __m256i index = begin;
+        for (int j = 0; j < max_degree; ++j) {
+            __m256i active = _mm256_and_si256(left, _mm256_cmpgt_epi32(end, index));
+            __m256i other = _mm256_mask_i32gather_epi32(zero, neighbor, index, active, 4);
+            __m256i other_side = _mm256_mask_i32gather_epi32(zero, side, other, active, 4);
+            cut = _mm256_add_epi32(cut, other_side);
+            index = _mm256_add_epi32(index, one);
+        }
+    }
+    long long total = sum64(widenAdd(_mm256_setzero_si256(), cut));
+    for (; i < n; ++i) {
+        if (side[i] != 0) continue;
+        for (int k = offset[i]; k < offset[i + 1]; ++k)
+            total += side[neighbor[k]];
+    }
+    return total;
+}
+
+__attribute__((target("avx2")))
+long long displacement(const int* x, const int* y, const int* final_x, const int* final_y, int n) {
+    __m256i sum = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i dx = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(final_x + i)),
+                                      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)));
+        __m256i dy = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(final_y + i)),
+                                      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i)));
+        // |dx| + |dy| may not fit an int32, widen each
+        sum = widenAdd(sum, _mm256_abs_epi32(dx));
+        sum = widenAdd(sum, _mm256_abs_epi32(dy));
+    }
+    long long total = sum64(sum);
+    for (; i < n; ++i)
+        total += std::abs(final_x[i] - x[i]) + std::abs(final_y[i] - y[i]);
+    return total;
+}
+
+__attribute__((target("avx2")))
+void areaStats(const int* area, int n, long long& total, int& max) {
+    __m256i sum = _mm256_setzero_si256(), top = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(area + i));
+        sum = widenAdd(sum, a);
+        top = _mm256_max_epi32(top, a);
+    }
+    total = sum64(sum);
+    max = max32(top);
+    for (; i < n; ++i) {
+        total += area[i];
+        max = std::max(max, area[i]);
+    }
+}
+
+}  // namespace avx2
+#endif
+
+
+/*******************************
+ *
+ *    Dispatch
+ *
+ *******************************/
+
+Isa detectIsa() {
+#ifdef PLACEMENT_KERNELS_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        return Isa::kAvx2;
+#endif
+    return Isa::kScalar;
+}
+
+std::atomic<Isa>& activeIsaRef() {
+    static std::atomic<Isa> isa{detectIsa()};
+    return isa;
+}
+
+Isa activeIsa() {
+    return activeIsaRef().load(std::memory_order_relaxed);
+}
+
+void setIsa(Isa isa) {
+    activeIsaRef().store(isa == Isa::kAvx2 ? detectIsa() : Isa::kScalar, std::memory_order_relaxed);
+}
+
+const char* isaName(Isa isa) {
+    return isa == Isa::kAvx2 ? "avx2" : "scalar";
+}
+
+void sideArea(const int* side, const int* area, int n, long long& left, long long& right) {
+#ifdef PLACEMENT_KERNELS_AVX2
+    if (activeIsa() == Isa::kAvx2)
+        return avx2::sideArea(side, area, n, left, right);
+#endif
+    scalar::sideArea(side, area, n, left, right);
+}
+
+long long cutCount(const int* offset, const int* neighbor, int n, const int* side) {
+#ifdef PLACEMENT_KERNELS_AVX2
+    if (activeIsa() == Isa::kAvx2)
+        return avx2::cutCount(offset, neighbor, n, side);
+#endif
+    return scalar::cutCount(offset, neighbor, n, side);
+}
+
+long long displacement(const int* x, const int* y, const int* final_x, const int* final_y, int n) {
+#ifdef PLACEMENT_KERNELS_AVX2
+    if (activeIsa() == Isa::kAvx2)
+        return avx2::displacement(x, y, final_x, final_y, n);
+#endif
+    return scalar::displacement(x, y, final_x, final_y, n);
+}
+
+void areaStats(const int* area, int n, long long& total, int& max) {
+#ifdef PLACEMENT_KERNELS_AVX2
+    if (activeIsa() == Isa::kAvx2)
+        return avx2::areaStats(area, n, total, max);
+#endif
+    scalar::areaStats(area, n, total, max);
+}
+
+}  // namespace placement::kernels
+
+#endif  // SRC_PLACEMENT_KERNELS_HPP_
@@ -1,170 +1,200 @@
 #ifndef SRC_PLACEMENT_LEGALIZATION_ABACUS_HPP_
 #define SRC_PLACEMENT_LEGALIZATION_ABACUS_HPP_
 
+#include <stdexcept>
+#include <string>
+
 #include <placement/system.hpp>
+#include <placement/die_layout.hpp>
+#include <placement/blockage.hpp>
+#include <placement/thread_pool.hpp>
+#include <placement/radix_sort.hpp>
+#include <placement/profiler.hpp>
 
 namespace placement {
 
+/*cut the rows into segments around the terminals, once per System*/
+void blockRows(backend::System& system);
+
 /*Legalization with Minimal Displacement*/
 class LegalizationAbacus {
  public:
     using system_ptr_type =  std::shared_ptr<backend::System>;
-    using cell_ptr = std::shared_ptr<backend::Cell>;
-    using terminal_ptr = std::shared_ptr<backend::Terminal>;
     explicit LegalizationAbacus(std::shared_ptr<backend::System> system_ptr)
     : system_ptr_(system_ptr) {}
     ~LegalizationAbacus() = default;
 
+    /*block the rows by terminals and build the shared layout*/
     void initialize();
-    system_ptr_type placement();
+    /*each chip is cut into horizontal bands by the row count alone, the
+      pool of num_threads workers only schedules them, so the result does
+      not depend on num_threads*/
+    system_ptr_type placement(int num_threads = 1);
  private:
     system_ptr_type system_ptr_{nullptr};
-
-    int binarySearchRow(const cell_ptr& cell);
-    bool attempPlace(backend::Row& row, const cell_ptr& cell, int& best_cost, backend::Subrow* &best_subrow_place);
+    backend::DieLayout layout_;
+    /*a cell never leaves its band, so every band edge costs displacement.
+      case4 (500 rows, seed 7): 1 band 9.316e6, 2 bands 9.349e6, 3 bands
+      9.438e6, 6 bands 9.473e6. 250 rows keeps dies up to 499 rows in one
+      band and splits taller ones at about +0.35% per edge.*/
+    int min_band_rows_ = 250;
+
+    void sortCells(std::vector<int>& cell_list);
+    std::vector<int> placeBand(backend::ChipRows& chip_rows,
+                               const std::vector<int>& cell_list,
+                               int first_row, int last_row);
 };
 
-void LegalizationAbacus::initialize() {
-    auto& terminal_list = system_ptr_->terminal_list;
-    auto& cell_list = system_ptr_->cell_list;
-    auto& row_list = system_ptr_->row_list;
-    /*sort terminals by x coordinate*/
-    std::sort(terminal_list.begin(), terminal_list.end(),
-    [](terminal_ptr t1, terminal_ptr t2) {return t1->x < t2->x;});
-
-    /*initialize terminal in row*/
-    // std::cout <<  system_ptr_<< std::endl;
-    for (auto terminal : terminal_list) {
-        for (auto &row : row_list) {
-            row.block(*terminal);
-        }
-    }
+void blockRows(backend::System& system) {
+    if (system.rows_blocked) return;
+    backend::BlockageIndex index(system.row_list, system.terminal_list);
+    index.cut(system.row_list);
+    system.rows_blocked = true;
 }
 
+void LegalizationAbacus::initialize() {
+    blockRows(*system_ptr_);
+    layout_ = backend::DieLayout(system_ptr_->row_list);
+}
 
-LegalizationAbacus::system_ptr_type LegalizationAbacus::placement() {
-    auto row_list = system_ptr_->row_list;
-    // change cell_list order
-    auto& left_cell_list = system_ptr_->left_cell_list;
-    std::sort(left_cell_list.begin(), left_cell_list.end(),
-    [](const cell_ptr& c1, const cell_ptr& c2){
-        if (c1->x == c2->x)
-            return c1->width < c2->width;
-        return c1->x < c2->x;
-    });
-
-
-    for (auto& cell : left_cell_list) {
-        int best_cost = std::numeric_limits<int>::max();
-        backend::Subrow *best_place = nullptr;
-        int start_row = binarySearchRow(cell);
-
-        // std::cout << start_row << std::endl;
-        int range = 18;
-        for (int i = start_row - range; i < start_row + range; ++i) {
-            if (i >= 0 && i < row_list.size()) {
-                attempPlace(row_list[i], cell, best_cost, best_place);
-            }
-        }
-
-        for (int i = start_row - range - 1; i >= 0; --i)
-            if (!attempPlace(row_list[i], cell, best_cost, best_place))
-                break;
-
-        for (int i = start_row - range + 1; i < row_list.size(); ++i)
-            if (!attempPlace(row_list[i], cell, best_cost, best_place))
-                break;
 
-        if (best_place) {
-            best_place->place(cell);
-            best_place->backup();
-            best_place->cost = best_place->getPosition();
-            best_place->remain_space -= cell->width;
+LegalizationAbacus::system_ptr_type LegalizationAbacus::placement(int num_threads) {
+    /*bands of rows, a cell belongs to the band of its nearest row*/
+    const int num_rows = layout_.numRows();
+    const int num_bands = std::max(1, num_rows / min_band_rows_);
+    std::vector<int> band_row_list(num_bands + 1);
+    for (int b = 0; b <= num_bands; ++b)
+        band_row_list[b] = num_rows * b / num_bands;
+
+    /*the clusters of a band come from its own arena, all released when
+      placement returns. only one thread works on a band at a time*/
+    std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> arena_list;
+    std::vector<std::pmr::memory_resource*> row_resource_list[2];
+    for (int chip = 0; chip < 2; ++chip) {
+        row_resource_list[chip].resize(num_rows);
+        for (int band = 0; band < num_bands; ++band) {
+            arena_list.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>());
+            for (int row = band_row_list[band]; row < band_row_list[band + 1]; ++row)
+                row_resource_list[chip][row] = arena_list.back().get();
         }
     }
 
-
-    // right
-    auto& row_list2 = system_ptr_->row_list;
-    // change cell_list order
-    auto& right_cell_list = system_ptr_->right_cell_list;
-    std::sort(right_cell_list.begin(), right_cell_list.end(),
-    [](const cell_ptr& c1, const cell_ptr& c2){
-        if (c1->x == c2->x)
-            return c1->width < c2->width;
-        return c1->x < c2->x;
-    });
-
-
-    for (auto& cell : right_cell_list) {
-        int best_cost = std::numeric_limits<int>::max();
-        backend::Subrow *best_place = nullptr;
-        int start_row = binarySearchRow(cell);
-
-        // std::cout << start_row << std::endl;
-        int range = 18;
-        for (int i = start_row - range; i < start_row + range; ++i) {
-            if (i >= 0 && i < row_list2.size()) {
-                attempPlace(row_list2[i], cell, best_cost, best_place);
-            }
+    /*the chips are independent, each keeps its own state over the layout*/
+    const backend::LegalizeView cells(system_ptr_->cells);
+    backend::ChipRows chip_rows[2] = {backend::ChipRows(layout_, cells, row_resource_list[0]),
+                                      backend::ChipRows(layout_, cells, row_resource_list[1])};
+    std::vector<int>* chip_cell_list[2] = {&system_ptr_->left_cell_list,
+                                           &system_ptr_->right_cell_list};
+
+    std::unique_ptr<ThreadPool> pool;
+    if (num_threads > 1)
+        pool = std::make_unique<ThreadPool>(num_threads);
+
+    /*the cells of each chip in the shared x order, no sort per chip*/
+    const auto& x_order = cellXOrder(*system_ptr_, pool.get());
+    const auto& chip_list = system_ptr_->cells.chip_list;
+    std::vector<std::vector<int>> band_cell_list(2*num_bands);
+    for (int chip = 0; chip < 2; ++chip) {
+        // change cell_list order
+        auto& cell_list = *chip_cell_list[chip];
+        cell_list.clear();
+        for (int cell : x_order)
+            if (chip_list[cell] == chip)
+                cell_list.push_back(cell);
+        for (int cell : cell_list) {
+            int row = layout_.nearestRow(cells.y[cell]);
+            int band = std::upper_bound(band_row_list.begin(), band_row_list.end(), row)
+                     - band_row_list.begin() - 1;
+            band_cell_list[chip*num_bands + std::min(band, num_bands - 1)].push_back(cell);
         }
+    }
 
-        for (int i = start_row - range - 1; i >= 0; --i)
-            if (!attempPlace(row_list2[i], cell, best_cost, best_place))
-                break;
-
-        for (int i = start_row - range + 1; i < row_list2.size(); ++i)
-            if (!attempPlace(row_list2[i], cell, best_cost, best_place))
-                break;
+    /*every band owns its rows and its cells, so bands never share state*/
+    std::vector<std::vector<int>> overflow_list(2*num_bands);
+    auto placeTask = [&](int task) {
+        int chip = task / num_bands, band = task % num_bands;
+        overflow_list[task] = placeBand(chip_rows[chip], band_cell_list[task],
+                                        band_row_list[band], band_row_list[band + 1]);
+    };
+    if (pool) {
+        pool->parallelFor(0, 2*num_bands, placeTask);
+    } else {
+        for (int task = 0; task < 2*num_bands; ++task)
+            placeTask(task);
+    }
 
-        if (best_place) {
-            best_place->place(cell);
-            best_place->backup();
-            best_place->cost = best_place->getPosition();
-            best_place->remain_space -= cell->width;
+    /*reconcile cells that did not fit into their band, in a fixed order*/
+    for (int chip = 0; chip < 2; ++chip) {
+        std::vector<int> cell_list;
+        for (int band = 0; band < num_bands; ++band) {
+            const auto& overflow = overflow_list[chip*num_bands + band];
+            cell_list.insert(cell_list.end(), overflow.begin(), overflow.end());
         }
+        if (cell_list.empty()) continue;
+        Profiler::instance().add("overflow_cells", cell_list.size());
+        sortCells(cell_list);
+        auto unplaced = placeBand(chip_rows[chip], cell_list, 0, num_rows);
+        if (!unplaced.empty())
+            throw std::runtime_error(std::to_string(unplaced.size())
+                                     + " cells fit in no row segment of chip " + std::to_string(chip));
     }
+    Profiler::instance().add("cluster_collapses",
+                             chip_rows[0].numCollapses() + chip_rows[1].numCollapses());
 
     // int cost = 0;
     // for (auto& row : row_list)
     //     cost += row.calCost();
 
     // system_ptr_->legalization_cost = cost;
- 
+
     return std::move(system_ptr_);
 }
 
-bool LegalizationAbacus::attempPlace(backend::Row& row,
-const cell_ptr& cell, int& best_cost, backend::Subrow* &best_subrow_place) {
-    auto place = row.placeRow(cell);
-    auto& subrow_place = place.first;
-    auto& cost = place.second;
-    if (subrow_place && cost < best_cost) {
-        best_cost = cost;
-        best_subrow_place = subrow_place;
-        return true;
-    } else if (subrow_place) {
-        return false;
-    }
-
-    return true;
+void LegalizationAbacus::sortCells(std::vector<int>& cell_list) {
+    const auto& cells = system_ptr_->cells;
+    std::sort(cell_list.begin(), cell_list.end(),
+    [&](int c1, int c2){
+        if (cells.x_list[c1] != cells.x_list[c2])
+            return cells.x_list[c1] < cells.x_list[c2];
+        if (cells.width_list[c1] != cells.width_list[c2])
+            return cells.width_list[c1] < cells.width_list[c2];
+        return c1 < c2;  // as cellXOrder
+    });
 }
 
+/*Abacus over rows [first_row, last_row), return the cells that found no room*/
+std::vector<int> LegalizationAbacus::placeBand(
+backend::ChipRows& chip_rows, const std::vector<int>& cell_list,
+int first_row, int last_row) {
+    const auto& y_list = system_ptr_->cells.y_list;
+    std::vector<int> overflow;
+    long long num_trials = 0;
+    for (int cell : cell_list) {
+        const int y = y_list[cell];
+        int best_cost = std::numeric_limits<int>::max();
+        int best_segment = -1;
+        int start_row = std::min(std::max(layout_.nearestRow(y), first_row), last_row - 1);
+
+        /*best-first over rows by vertical displacement, which bounds the cost
+          of a row from below, stop once neither direction can beat the best*/
+        int up = start_row, down = start_row - 1;
+        while (true) {
+            int up_bound = up < last_row ? std::abs(layout_.rowY(up) - y) : INT_MAX;
+            int down_bound = down >= first_row ? std::abs(layout_.rowY(down) - y) : INT_MAX;
+            if (std::min(up_bound, down_bound) >= best_cost)
+                break;
+            int row = up_bound <= down_bound ? up++ : down--;
+            num_trials += chip_rows.placeRow(row, cell, best_cost, best_segment);
+        }
 
-int LegalizationAbacus::binarySearchRow(const cell_ptr& cell) {
-    const auto& row_list = system_ptr_->row_list;
-    int left = 0;
-    int right = row_list.size() - 1;
-    while (left < right) {
-        int mid = (left + right) / 2;
-        if (row_list[mid].y == cell->y)
-            return mid;
-        else if (row_list[mid].y > cell->y)
-            right = mid - 1;
-        else
-            left = mid + 1;
+        if (best_segment >= 0) {
+            chip_rows.commit(best_segment, cell);
+        } else {
+            overflow.push_back(cell);
+        }
     }
-    return std::max(0, left);
+    Profiler::instance().add("trial_placements", num_trials);
+    return overflow;
 }
 
 
@@ -0,0 +1,148 @@
+#ifndef SRC_PLACEMENT_MAPPED_INPUT_HPP_
+#define SRC_PLACEMENT_MAPPED_INPUT_HPP_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <charconv>
+
+#include <placement/system.hpp>
+#include <placement/kernels.hpp>
+
+namespace placement {
+
+/*Same format and result as Input, but the file is memory-mapped and
+  scanned in place: integers by std::from_chars, names are copied once
+  into System::name_arena.*/
+class MappedInput {
+ public:
+    using system_ptr_type = std::unique_ptr<backend::System>;
+
+    /* --- Constructor & Destructor --- */
+    explicit MappedInput(const std::string& path);
+    ~MappedInput();
+    MappedInput(const MappedInput&) = delete;
+    MappedInput& operator=(const MappedInput&) = delete;
+    /*----------------------------------*/
+
+    /*read input file to get layout info*/
+    system_ptr_type readFile(void);
+
+ private:
+    system_ptr_type system_ptr_{nullptr};
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    const char* cur_ = nullptr;
+    const char* end_ = nullptr;
+
+    std::string_view token();
+    int integer();
+};
+
+
+MappedInput::MappedInput(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+        if (fd >= 0) ::close(fd);
+        std::cerr << "no such file!! " <<  std::endl;
+        return;
+    }
+
+    size_ = st.st_size;
+    if (size_ > 0) {
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            size_ = 0;
+            std::cerr << "cannot map file!! " <<  std::endl;
+            return;
+        }
+        data_ = static_cast<const char*>(data);
+        ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+    } else {
+        ::close(fd);
+    }
+    cur_ = data_;
+    end_ = data_ + size_;
+    system_ptr_ = std::make_unique<backend::System>();
+}
+
+MappedInput::~MappedInput() {
+    if (data_)
+        ::munmap(const_cast<char*>(data_), size_);
+}
+
+/*next whitespace separated token, empty at the end of file*/
+std::string_view MappedInput::token() {
+    while (cur_ < end_ && static_cast<unsigned char>(*cur_) <= ' ')
+        ++cur_;
+    const char* first = cur_;
+    while (cur_ < end_ && static_cast<unsigned char>(*cur_) > ' ')
+        ++cur_;
+    return std::string_view(first, cur_ - first);
+}
+
+int MappedInput::integer() {
+    auto word = token();
+    int value = 0;
+    auto [ptr, ec] = std::from_chars(word.data(), word.data() + word.size(), value);
+    if (ec != std::errc() || ptr != word.data() + word.size())
+        throw std::invalid_argument("expected an integer, got \"" + std::string(word) + "\"");
+    return value;
+}
+
+MappedInput::system_ptr_type MappedInput::readFile() {
+    if (!system_ptr_)
+        return nullptr;
+
+    for (auto key = token(); !key.empty(); key = token()) {
+        if (key == "DieSize") {
+            system_ptr_->chip_width = integer();
+            system_ptr_->chip_height = integer();
+        } else if (key == "DieRows") {
+            int row_height = integer();
+            int num_rows = integer();
+            system_ptr_->row_height = row_height;
+            system_ptr_->num_rows = num_rows;
+
+            system_ptr_->row_list.reserve(num_rows);
+            for (int i = 0; i < num_rows; ++i)
+                system_ptr_->row_list.push_back({0, row_height*i, system_ptr_->chip_width, row_height});
+        } else if (key == "Terminal") {
+            int num_terminals = integer();
+            system_ptr_->num_terminals = num_terminals;
+            system_ptr_->terminal_list.resize(num_terminals);
+            for (int i = 0; i < num_terminals; ++i) {
+                auto& terminal = system_ptr_->terminal_list[i];
+                terminal.name = system_ptr_->name_arena.intern(token());
+                terminal.x = integer();
+                terminal.y = integer();
+                terminal.width = integer();
+                terminal.height = integer();
+            }
+        } else if (key == "NumCell") {
+            int num_cells = integer();
+            system_ptr_->num_cells = num_cells;
+            system_ptr_->cells.reserve(num_cells);
+
+            for (int i = 0; i < num_cells; ++i) {
+                auto name = system_ptr_->name_arena.intern(token());
+                int x = integer();
+                int y = integer();
+                int width = integer();
+                int height = integer();
+                system_ptr_->cells.add(name, x, y, width, height);
+            }
+            const auto& area_list = system_ptr_->cells.area_list;
+            kernels::areaStats(area_list.data(), area_list.size(),
+                               system_ptr_->total_cell_area, system_ptr_->max_cell_area);
+        }
+    }
+    return std::move(system_ptr_);
+}
+
+}  // namespace placement
+
+#endif  // SRC_PLACEMENT_MAPPED_INPUT_HPP_
@@ -0,0 +1,384 @@
+#ifndef SRC_PLACEMENT_MULTILEVEL_PARTITION_HPP_
+#define SRC_PLACEMENT_MULTILEVEL_PARTITION_HPP_
+
+#include <placement/graph_partition.hpp>
+
+namespace placement {
+
+/*Multilevel max-cut partition (coarsen / partition / uncoarsen).
+  Overlapping cells want different chips, so contracting an edge must not
+  glue its endpoints to the same side. A coarse node therefore remembers an
+  orientation (flip) for each member: heavy positive edges are matched with
+  opposite orientation, heavy negative ones with the same orientation, and
+  coarse edges carry signed weights (w > 0: cut when the sides differ).
+  The coarsest graph is partitioned greedily and every level is refined by
+  FM under the same area window as GraphPartition.*/
+class MultilevelPartition {
+ public:
+    using system_ptr_type = std::shared_ptr<backend::System>;
+    explicit MultilevelPartition(system_ptr_type system_ptr,
+                                 unsigned seed = std::random_device{}())
+    : system_ptr_(system_ptr), rng_(seed) {}
+    ~MultilevelPartition() = default;
+
+    /*num_threads only builds the overlap graph*/
+    void initialize(int num_threads = 1);
+    system_ptr_type partition(int num_passes = 8);
+
+ private:
+    struct Level {
+        backend::CsrGraph graph;  // signed edge weights
+        std::vector<long long> area_list[2];  // area on own side / other side
+        std::vector<int> coarse_list;  // node -> node of the next level
+        std::vector<char> flip_list;  // orientation inside the coarse node
+        int numNodes() const { return graph.numNodes(); }
+    };
+
+    system_ptr_type system_ptr_;
+    std::mt19937 rng_;
+    std::vector<Level> level_list_;  // [0] is the cell level
+    long long total_area_ = 0;
+    long long max_cell_area_ = 0;
+    int coarsest_size_ = 200;
+    long long num_moves_ = 0;  // tried moves over all refinements
+
+    bool coarsenLevel(Level& fine, Level& coarse);
+    void initialPartition(const Level& level, std::vector<int>& side_list);
+    bool refine(const Level& level, std::vector<int>& side_list, long long window);
+    long long leftArea(const Level& level, const std::vector<int>& side_list) const;
+    long long moveArea(const Level& level, int node, int side) const {
+        // change of the left area when node leaves side
+        long long delta = level.area_list[1][node] - level.area_list[0][node];
+        return side == 0 ? delta : -delta;
+    }
+};
+
+
+void MultilevelPartition::initialize(int num_threads) {
+    buildOverlapGraph(*system_ptr_, num_threads);
+
+    /*cell level: unit weights, area on own side*/
+    const auto& area_list = system_ptr_->cells.area_list;
+    level_list_.clear();
+    level_list_.emplace_back();
+    auto& level = level_list_.back();
+    level.graph = system_ptr_->overlap_graph;
+    level.graph.weight_list.assign(level.graph.neighbor_list.size(), 1);
+    level.area_list[0].assign(area_list.begin(), area_list.end());
+    level.area_list[1].assign(area_list.size(), 0);
+    total_area_ = 0;
+    max_cell_area_ = 0;
+    for (int area : area_list) {
+        total_area_ += area;
+        max_cell_area_ = std::max<long long>(max_cell_area_, area);
+    }
+
+    /*coarsen until a few hundred nodes are left*/
+    while (level_list_.back().numNodes() > coarsest_size_) {
+        Level coarse;
+        if (!coarsenLevel(level_list_.back(), coarse))
+            break;
+        level_list_.push_back(std::move(coarse));
+    }
+}
+
+MultilevelPartition::system_ptr_type MultilevelPartition::partition(int num_passes) {
+    /*initial partition at the coarsest level*/
+    std::vector<int> side_list;
+    initialPartition(level_list_.back(), side_list);
+
+    for (int l = level_list_.size() - 1; l >= 0; --l) {
+        const auto& level = level_list_[l];
+        // coarse nodes cannot always hit the cell-level window
+        long long window = max_cell_area_;
+        for (int v = 0; v < level.numNodes(); ++v)
+            window = std::max(window, std::abs(level.area_list[0][v] - level.area_list[1][v]));
+
+        for (int pass = 0; pass < num_passes; ++pass)
+            if (!refine(level, side_list, window))
+                break;
+
+        /*project to the finer level*/
+        if (l > 0) {
+            const auto& fine = level_list_[l - 1];
+            std::vector<int> fine_side_list(fine.numNodes());
+            for (int v = 0; v < fine.numNodes(); ++v)
+                fine_side_list[v] = side_list[fine.coarse_list[v]] ^ fine.flip_list[v];
+            side_list.swap(fine_side_list);
+        }
+    }
+
+    /*cut size on the cell level*/
+    const auto& graph = system_ptr_->overlap_graph;
+    int cost = 0;
+    for (int v = 0; v < graph.numNodes(); ++v)
+        for (auto it = graph.begin(v); it != graph.end(v); ++it)
+            if (side_list[v] == 0 && side_list[*it] == 1)
+                cost++;
+
+    auto& profiler = Profiler::instance();
+    profiler.add("ml_levels", level_list_.size());
+    profiler.add("ml_moves", num_moves_);
+
+    writePartition(*system_ptr_, side_list, cost);
+    return std::move(system_ptr_);
+}
+
+
+/*******************************
+ *
+ *    Private Implemantation
+ *
+ *******************************/
+
+/*heavy-edge matching, return false if the graph barely shrinks*/
+bool MultilevelPartition::coarsenLevel(Level& fine, Level& coarse) {
+    const int num_nodes = fine.numNodes();
+    const auto& graph = fine.graph;
+    long long max_node_area = std::max(max_cell_area_, total_area_ / coarsest_size_);
+
+    std::vector<int> order(num_nodes);
+    for (int v = 0; v < num_nodes; ++v) order[v] = v;
+    std::shuffle(order.begin(), order.end(), rng_);
+
+    const int kUnmatched = -1;
+    auto nodeArea = [&](int v) { return fine.area_list[0][v] + fine.area_list[1][v]; };
+    fine.flip_list.assign(num_nodes, 0);
+
+    int num_coarse = 0;
+    int lonely = kUnmatched;  // pending node without free neighbors
+    fine.coarse_list.assign(num_nodes, kUnmatched);
+    for (int u : order) {
+        if (fine.coarse_list[u] != kUnmatched) continue;
+        int best = kUnmatched;
+        int best_weight = 0;
+        char best_flip = 0;
+        for (int k = graph.offset_list[u]; k < graph.offset_list[u + 1]; ++k) {
+            int v = graph.neighbor_list[k];
+            if (fine.coarse_list[v] != kUnmatched) continue;
+            if (nodeArea(u) + nodeArea(v) > max_node_area) continue;
+            if (std::abs(graph.weight_list[k]) > best_weight) {
+                best_weight = std::abs(graph.weight_list[k]);
+                best = v;
+                best_flip = graph.weight_list[k] > 0;  // cut edge: opposite side
+            }
+        }
+
+        if (best == kUnmatched && graph.degree(u) == 0) {
+            // pair isolated nodes in opposite orientation to keep them fine-grained for balance
+            if (lonely == kUnmatched) {
+                lonely = u;
+                continue;
+            }
+            best = lonely;
+            lonely = kUnmatched;
+            best_flip = 1;
+        }
+
+        fine.coarse_list[u] = num_coarse;
+        if (best != kUnmatched) {
+            fine.coarse_list[best] = num_coarse;
+            fine.flip_list[best] = best_flip;
+        }
+        num_coarse++;
+    }
+    if (lonely != kUnmatched)
+        fine.coarse_list[lonely] = num_coarse++;
+
+    if (num_coarse > 0.95 * num_nodes)
+        return false;
+
+    /*coarse node areas*/
+    coarse.area_list[0].assign(num_coarse, 0);
+    coarse.area_list[1].assign(num_coarse, 0);
+    std::vector<int> member_offset(num_coarse + 1, 0);
+    for (int v = 0; v < num_nodes; ++v) {
+        int c = fine.coarse_list[v];
+        int f = fine.flip_list[v];
+        coarse.area_list[0][c] += fine.area_list[f][v];
+        coarse.area_list[1][c] += fine.area_list[!f][v];
+        member_offset[c + 1]++;
+    }
+    for (int c = 0; c < num_coarse; ++c)
+        member_offset[c + 1] += member_offset[c];
+    std::vector<int> member_list(num_nodes);
+    std::vector<int> cursor(member_offset.begin(), member_offset.end() - 1);
+    for (int v = 0; v < num_nodes; ++v)
+        member_list[cursor[fine.coarse_list[v]]++] = v;
+
+    /*coarse edges: same orientation keeps the sign, opposite flips it*/
+    auto& coarse_graph = coarse.graph;
+    coarse_graph.offset_list.assign(1, 0);
+    coarse_graph.neighbor_list.clear();
+    coarse_graph.weight_list.clear();
+    std::vector<int> slot_list(num_coarse, -1);
+    for (int c = 0; c < num_coarse; ++c) {
+        int row_start = coarse_graph.neighbor_list.size();
+        for (int m = member_offset[c]; m < member_offset[c + 1]; ++m) {
+            int x = member_list[m];
+            for (int k = graph.offset_list[x]; k < graph.offset_list[x + 1]; ++k) {
+                int y = graph.neighbor_list[k];
+                int cy = fine.coarse_list[y];
+                if (cy == c) continue;  // fixed inside the coarse node
+                int weight = fine.flip_list[x] == fine.flip_list[y]
+                           ? graph.weight_list[k] : -graph.weight_list[k];
+                if (slot_list[cy] < row_start) {
+                    slot_list[cy] = coarse_graph.neighbor_list.size();
+                    coarse_graph.neighbor_list.push_back(cy);
+                    coarse_graph.weight_list.push_back(0);
+                }
+                coarse_graph.weight_list[slot_list[cy]] += weight;
+            }
+        }
+
+        // drop edges whose weights cancelled out
+        for (int k = row_start; k < static_cast<int>(coarse_graph.neighbor_list.size()); ++k)
+            slot_list[coarse_graph.neighbor_list[k]] = -1;
+        int end = row_start;
+        for (int k = row_start; k < static_cast<int>(coarse_graph.neighbor_list.size()); ++k) {
+            if (coarse_graph.weight_list[k] == 0) continue;
+            coarse_graph.neighbor_list[end] = coarse_graph.neighbor_list[k];
+            coarse_graph.weight_list[end] = coarse_graph.weight_list[k];
+            end++;
+        }
+        coarse_graph.neighbor_list.resize(end);
+        coarse_graph.weight_list.resize(end);
+        coarse_graph.offset_list.push_back(end);
+    }
+    return true;
+}
+
+/*greedy area balance, largest area difference first*/
+void MultilevelPartition::initialPartition(const Level& level, std::vector<int>& side_list) {
+    const int num_nodes = level.numNodes();
+    std::vector<int> order(num_nodes);
+    for (int v = 0; v < num_nodes; ++v) order[v] = v;
+    std::shuffle(order.begin(), order.end(), rng_);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return std::abs(level.area_list[0][a] - level.area_list[1][a])
+             > std::abs(level.area_list[0][b] - level.area_list[1][b]);
+    });
+
+    side_list.assign(num_nodes, 0);
+    long long left_area = 0, right_area = 0;
+    for (int v : order) {
+        long long own = level.area_list[0][v], other = level.area_list[1][v];
+        // side 0: left gets own, side 1: left gets other
+        if (std::abs((left_area + own) - (right_area + other))
+            <= std::abs((left_area + other) - (right_area + own))) {
+            side_list[v] = 0;
+            left_area += own;
+            right_area += other;
+        } else {
+            side_list[v] = 1;
+            left_area += other;
+            right_area += own;
+        }
+    }
+}
+
+long long MultilevelPartition::leftArea(const Level& level,
+                                        const std::vector<int>& side_list) const {
+    long long left_area = 0;
+    for (int v = 0; v < level.numNodes(); ++v)
+        left_area += level.area_list[side_list[v]][v];
+    return left_area;
+}
+
+/*one FM pass with rollback to the best prefix, return true if improved*/
+bool MultilevelPartition::refine(const Level& level, std::vector<int>& side_list,
+                                 long long window) {
+    const int num_nodes = level.numNodes();
+    const auto& graph = level.graph;
+    const int kScan = 32;  // candidates looked at per side and move
+    const int kStall = 256;  // stop after this many moves without improvement
+
+    int max_gain = 0;
+    for (int v = 0; v < num_nodes; ++v) {
+        int weighted_degree = 0;
+        for (int k = graph.offset_list[v]; k < graph.offset_list[v + 1]; ++k)
+            weighted_degree += std::abs(graph.weight_list[k]);
+        max_gain = std::max(max_gain, weighted_degree);
+    }
+
+    backend::GainBucket<int> buckets[2];
+    buckets[0].reset(num_nodes, max_gain);
+    buckets[1].reset(num_nodes, max_gain);
+    for (int v = 0; v < num_nodes; ++v) {
+        int gain = 0;
+        for (int k = graph.offset_list[v]; k < graph.offset_list[v + 1]; ++k)
+            gain += side_list[v] == side_list[graph.neighbor_list[k]]
+                  ? graph.weight_list[k] : -graph.weight_list[k];
+        buckets[side_list[v]].insert(v, gain);
+    }
+
+    long long left_area = leftArea(level, side_list);
+    auto imbalance = [&](long long area) {
+        return std::max(0LL, std::abs(2*area - total_area_) / 2 - window);
+    };
+
+    long long cut = 0, best_cut = 0;
+    long long best_imbalance = imbalance(left_area);
+    std::vector<int> move_list;
+    size_t best_len = 0;
+    while (move_list.size() - best_len < kStall) {
+        /*best gain move that keeps (or improves) the balance*/
+        int best = backend::GainBucket<int>::kNil;
+        for (int side = 0; side < 2; ++side) {
+            auto& bucket = buckets[side];
+            if (bucket.empty()) continue;
+            int scanned = 0;
+            for (int g = bucket.maxGain(); g >= -max_gain && scanned < kScan; --g) {
+                int v = bucket.front(g);
+                for (; v != bucket.kNil && scanned < kScan; v = bucket.next(v), ++scanned) {
+                    long long after = imbalance(left_area + moveArea(level, v, side));
+                    if (after == 0 || after < imbalance(left_area))
+                        break;
+                }
+                if (v != bucket.kNil && scanned < kScan) {
+                    if (best == bucket.kNil || g > buckets[side_list[best]].gain(best))
+                        best = v;
+                    break;
+                }
+            }
+        }
+        if (best == backend::GainBucket<int>::kNil)
+            break;
+
+        /*move and lock*/
+        int from = side_list[best];
+        cut += buckets[from].gain(best);
+        left_area += moveArea(level, best, from);
+        buckets[from].remove(best);
+        side_list[best] = !from;
+        move_list.push_back(best);
+        for (int k = graph.offset_list[best]; k < graph.offset_list[best + 1]; ++k) {
+            int v = graph.neighbor_list[k];
+            auto& bucket = buckets[side_list[v]];
+            if (!bucket.contains(v)) continue;
+            // the edge flips between cut and uncut
+            int weight = graph.weight_list[k];
+            bucket.add(v, side_list[v] == from ? -2*weight : 2*weight);
+        }
+
+        long long now_imbalance = imbalance(left_area);
+        if (now_imbalance < best_imbalance
+            || (now_imbalance == best_imbalance && cut > best_cut)) {
+            best_imbalance = now_imbalance;
+            best_cut = cut;
+            best_len = move_list.size();
+        }
+    }
+
+    /*roll back to the best prefix*/
+    num_moves_ += move_list.size();
+    for (size_t m = move_list.size(); m > best_len; --m) {
+        int v = move_list[m - 1];
+        side_list[v] = !side_list[v];
+    }
+    return best_len > 0;
+}
+
+}  // namespace placement
+
+#endif  // SRC_PLACEMENT_MULTILEVEL_PARTITION_HPP_
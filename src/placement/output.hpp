@@ -1,11 +1,248 @@
 #ifndef SRC_PLACEMENT_OUTPUT_HPP_
 #define SRC_PLACEMENT_OUTPUT_HPP_
 
+#include <charconv>
 
-// #include <partition/plane.hpp>
+#include <placement/system.hpp>
 
 namespace placement {
 
+/*Large buffer in front of an ofstream, integers are formatted in place
+  by std::to_chars and the file is written in big chunks.*/
+class BufferedWriter {
+ public:
+    explicit BufferedWriter(const std::string& path, size_t capacity = size_t{1} << 20)
+    : out_(path, std::ofstream::out | std::ofstream::binary), buffer_(std::max<size_t>(capacity, 64)) {}
+    ~BufferedWriter() { flush(); }
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    bool good() const { return out_.good(); }
+
+    BufferedWriter& put(std::string_view text);
+    BufferedWriter& put(char c);
+    BufferedWriter& put(int value);
+    BufferedWriter& putBytes(const void* data, size_t size);
+    void flush();
+
+ private:
+    std::ofstream out_;
+    std::vector<char> buffer_;
+    size_t used_ = 0;
+
+    /*room for size more bytes, flushing first if needed*/
+    char* reserve(size_t size);
+};
+
+
+/*Result of a run, text for the verifier or a compact binary form.
+  binary: "PLRS", uint32 version, uint32 num_cells, then per cell
+  int32 index, int32 final_x, int32 final_y, uint8 chip (13 bytes), in the
+  byte order of the writing host. a file from the other byte order fails the
+  version check, so it is meant for the machine or cluster that wrote it.*/
+class Output {
+ public:
+    using system_ptr_type = std::shared_ptr<backend::System>;
+
+    explicit Output(system_ptr_type system_ptr)
+    : system_ptr_(system_ptr) {}
+    ~Output() = default;
+
+    /*one "name final_x final_y chip" line per cell*/
+    bool writeFile(const std::string& path);
+    bool writeBinary(const std::string& path);
+    /*read a binary result of the same design back into the cell table*/
+    bool readBinary(const std::string& path);
+    /*read a text result of the same design back, cells are matched by name*/
+    bool readFile(const std::string& path);
+    /*either format, told apart by the binary magic*/
+    bool readResult(const std::string& path);
+
+ private:
+    static constexpr char kMagic[4] = {'P', 'L', 'R', 'S'};
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kHeaderSize = 12;
+    static constexpr size_t kRecordSize = 13;
+
+    system_ptr_type system_ptr_{nullptr};
+};
+
+
+BufferedWriter& BufferedWriter::put(std::string_view text) {
+    if (text.size() > buffer_.size()) {
+        flush();
+        out_.write(text.data(), text.size());
+        return *this;
+    }
+    std::memcpy(reserve(text.size()), text.data(), text.size());
+    used_ += text.size();
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::put(char c) {
+    *reserve(1) = c;
+    ++used_;
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::put(int value) {
+    char* first = reserve(16);
+    auto result = std::to_chars(first, first + 16, value);
+    used_ += result.ptr - first;
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::putBytes(const void* data, size_t size) {
+    return put(std::string_view(static_cast<const char*>(data), size));
+}
+
+void BufferedWriter::flush() {
+    if (used_ > 0)
+        out_.write(buffer_.data(), used_);
+    used_ = 0;
+    out_.flush();
+}
+
+char* BufferedWriter::reserve(size_t size) {
+    if (buffer_.size() - used_ < size) {
+        out_.write(buffer_.data(), used_);
+        used_ = 0;
+    }
+    return buffer_.data() + used_;
+}
+
+
+bool Output::writeFile(const std::string& path) {
+    BufferedWriter out(path);
+    if (!out.good()) {
+        std::cerr << "cannot open " << path << std::endl;
+        return false;
+    }
+
+    const auto& cells = system_ptr_->cells;
+    for (int i = 0; i < cells.size(); ++i) {
+        out.put(cells.name_list[i]).put(' ')
+           .put(cells.final_x_list[i]).put(' ')
+           .put(cells.final_y_list[i]).put(' ')
+           .put(static_cast<int>(cells.chip_list[i])).put('\n');
+    }
+    out.flush();
+    return out.good();
+}
+
+bool Output::writeBinary(const std::string& path) {
+    BufferedWriter out(path);
+    if (!out.good()) {
+        std::cerr << "cannot open " << path << std::endl;
+        return false;
+    }
+
+    const auto& cells = system_ptr_->cells;
+    const uint32_t num_cells = cells.size();
+    out.putBytes(kMagic, sizeof(kMagic));
+    out.putBytes(&kVersion, sizeof(kVersion));
+    out.putBytes(&num_cells, sizeof(num_cells));
+
+    char record[kRecordSize];
+    for (int i = 0; i < cells.size(); ++i) {
+        int32_t field[3] = {i, cells.final_x_list[i], cells.final_y_list[i]};
+        std::memcpy(record, field, sizeof(field));
+        record[12] = static_cast<char>(cells.chip_list[i]);
+        out.putBytes(record, kRecordSize);
+    }
+    out.flush();
+    return out.good();
+}
+
+bool Output::readBinary(const std::string& path) {
+    std::ifstream in(path, std::ifstream::in | std::ifstream::binary);
+    if (in.fail()) {
+        std::cerr << "no such file!! " <<  std::endl;
+        return false;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    auto& cells = system_ptr_->cells;
+    char magic[4];
+    uint32_t version = 0, num_cells = 0;
+    if (data.size() < kHeaderSize)
+        throw std::invalid_argument("binary result is truncated");
+    std::memcpy(magic, data.data(), 4);
+    std::memcpy(&version, data.data() + 4, 4);
+    std::memcpy(&num_cells, data.data() + 8, 4);
+    if (std::memcmp(magic, kMagic, 4) != 0 || version != kVersion)
+        throw std::invalid_argument("not a binary result of this version");
+    if (num_cells != static_cast<uint32_t>(cells.size())
+        || data.size() != kHeaderSize + kRecordSize * num_cells)
+        throw std::invalid_argument("binary result does not match the design");
+
+    std::vector<char> seen(num_cells, 0);
+    for (uint32_t r = 0; r < num_cells; ++r) {
+        const char* record = data.data() + kHeaderSize + kRecordSize * r;
+        int32_t field[3];
+        std::memcpy(field, record, sizeof(field));
+        if (field[0] < 0 || field[0] >= cells.size())
+            throw std::invalid_argument("cell index out of range in binary result");
+        if (seen[field[0]])
+            throw std::invalid_argument("cell index repeated in binary result");
+        const uint8_t chip = static_cast<uint8_t>(record[12]);
+        if (chip > 1)
+            throw std::invalid_argument("chip is not 0 or 1 in binary result");
+        seen[field[0]] = 1;
+        cells.final_x_list[field[0]] = field[1];
+        cells.final_y_list[field[0]] = field[2];
+        cells.chip_list[field[0]] = chip;
+    }
+    if (std::find(seen.begin(), seen.end(), 0) != seen.end())
+        throw std::invalid_argument("cell missing from binary result");
+    return true;
+}
+
+bool Output::readFile(const std::string& path) {
+    std::ifstream in(path, std::ifstream::in);
+    if (in.fail()) {
+        std::cerr << "no such file!! " <<  std::endl;
+        return false;
+    }
+
+    auto& cells = system_ptr_->cells;
+    std::unordered_map<std::string_view, int> id_map;
+    id_map.reserve(cells.size());
+    for (int i = 0; i < cells.size(); ++i)
+        id_map.emplace(cells.name_list[i], i);
+
+    std::string name;
+    int x, y, chip;
+    int num_read = 0;
+    std::vector<char> seen(cells.size(), 0);
+    while (in >> name >> x >> y >> chip) {
+        auto it = id_map.find(name);
+        if (it == id_map.end())
+            throw std::invalid_argument("unknown cell " + name + " in result");
+        if (seen[it->second])
+            throw std::invalid_argument("cell " + name + " repeated in result");
+        if (chip != 0 && chip != 1)
+            throw std::invalid_argument("chip of cell " + name + " is not 0 or 1 in result");
+        seen[it->second] = 1;
+        cells.final_x_list[it->second] = x;
+        cells.final_y_list[it->second] = y;
+        cells.chip_list[it->second] = static_cast<uint8_t>(chip);
+        num_read++;
+    }
+    // no repeats, so every cell was read once
+    if (!in.eof() || num_read != cells.size())
+        throw std::invalid_argument("text result does not match the design");
+    return true;
+}
+
+bool Output::readResult(const std::string& path) {
+    std::ifstream in(path, std::ifstream::in | std::ifstream::binary);
+    char magic[4] = {};
+    in.read(magic, 4);
+    if (in.gcount() == 4 && std::memcmp(magic, kMagic, 4) == 0)
+        return readBinary(path);
+    return readFile(path);
+}
 
 }  // namespace placement
 
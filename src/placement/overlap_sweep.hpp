@@ -0,0 +1,208 @@
+#ifndef SRC_PLACEMENT_OVERLAP_SWEEP_HPP_
+#define SRC_PLACEMENT_OVERLAP_SWEEP_HPP_
+
+#include <placement/system.hpp>
+
+namespace placement {
+
+/*Report every overlapping pair of boxes by a sweep line over x.
+  The active set is keyed by y-interval over the compressed y1 coordinates:
+  per-y1 buckets (with a bitmap of the non-empty ones) answer
+  "starts inside [y1, y2)" and a segment tree answers "covers y1 strictly",
+  so each query costs O(log n + k). Lists are intrusive (index linked)
+  and expired boxes are unlinked lazily the next time a query meets them.*/
+class OverlapSweep {
+ public:
+    using box_type = backend::Box;
+    using pair_type = std::pair<int, int>;
+
+    explicit OverlapSweep(const std::vector<box_type>& box_list)
+    : box_list_(box_list) {}
+    ~OverlapSweep() = default;
+
+    /*call visit(i, j) once for every overlapping pair, i started first*/
+    template <typename Visitor>
+    void run(Visitor&& visit);
+
+    /*collect every overlapping pair*/
+    std::vector<pair_type> pairs();
+
+ private:
+    static constexpr int kNil = -1;
+
+    const std::vector<box_type>& box_list_;
+    std::vector<int> y_list_;  // sorted distinct y1
+    std::vector<std::pair<int, int>> rank_list_;  // box -> rank of y1, y2
+    std::vector<char> active_;
+
+    std::vector<int> bucket_head_;  // y1 rank -> first box
+    std::vector<int> bucket_next_;  // box -> next box in the same bucket
+    std::vector<uint64_t> bucket_bits_;  // non-empty buckets
+
+    int leaf_size_ = 1;
+    std::vector<int> tree_head_;  // segment tree node -> first entry
+    std::vector<int> entry_box_;  // entry pool, recycled through free_entry_
+    std::vector<int> entry_next_;
+    int free_entry_ = kNil;
+
+    void initialize();
+    void insert(int id);
+    void insertTree(int node, int id);
+    template <typename Visitor>
+    void queryBucket(int id, Visitor& visit);
+    template <typename Visitor>
+    void queryTree(int id, Visitor& visit);
+};
+
+
+template <typename Visitor>
+void OverlapSweep::run(Visitor&& visit) {
+    initialize();
+
+    /*boxes ordered by entering x and by leaving x*/
+    std::vector<std::pair<int, int>> enter_list, leave_list;
+    enter_list.reserve(box_list_.size());
+    leave_list.reserve(box_list_.size());
+    for (int i = 0; i < static_cast<int>(box_list_.size()); ++i) {
+        const auto& box = box_list_[i];
+        if (box.x1 >= box.x2 || box.y1 >= box.y2) continue;  // empty box
+        enter_list.emplace_back(box.x1, i);
+        leave_list.emplace_back(box.x2, i);
+    }
+    std::sort(enter_list.begin(), enter_list.end());
+    std::sort(leave_list.begin(), leave_list.end());
+
+    auto leave_it = leave_list.begin();
+    for (const auto& [x, id] : enter_list) {
+        // leaving first, boxes that only touch do not overlap
+        for (; leave_it->first <= x; ++leave_it)
+            active_[leave_it->second] = 0;
+
+        queryBucket(id, visit);
+        queryTree(id, visit);
+        insert(id);
+    }
+}
+
+std::vector<OverlapSweep::pair_type> OverlapSweep::pairs() {
+    std::vector<pair_type> pair_list;
+    run([&](int i, int j) { pair_list.emplace_back(i, j); });
+    return pair_list;
+}
+
+void OverlapSweep::initialize() {
+    const int num_boxes = box_list_.size();
+
+    /*compress y1 coordinates*/
+    y_list_.clear();
+    y_list_.reserve(num_boxes);
+    for (const auto& box : box_list_)
+        y_list_.push_back(box.y1);
+    std::sort(y_list_.begin(), y_list_.end());
+    y_list_.erase(std::unique(y_list_.begin(), y_list_.end()), y_list_.end());
+
+    auto rankY = [&](int y) -> int {
+        return std::lower_bound(y_list_.begin(), y_list_.end(), y) - y_list_.begin();
+    };
+    rank_list_.resize(num_boxes);
+    for (int i = 0; i < num_boxes; ++i)
+        rank_list_[i] = {rankY(box_list_[i].y1), rankY(box_list_[i].y2)};
+    active_.assign(num_boxes, 0);
+
+    const int num_y = y_list_.size();
+    bucket_head_.assign(num_y, kNil);
+    bucket_next_.assign(num_boxes, kNil);
+    bucket_bits_.assign(num_y / 64 + 1, 0);
+
+    leaf_size_ = 1;
+    while (leaf_size_ < num_y)
+        leaf_size_ <<= 1;
+    tree_head_.assign(2*leaf_size_, kNil);
+    entry_box_.clear();
+    entry_next_.clear();
+    free_entry_ = kNil;
+}
+
+void OverlapSweep::insert(int id) {
+    const auto [rank, end_rank] = rank_list_[id];
+    bucket_next_[id] = bucket_head_[rank];
+    bucket_head_[rank] = id;
+    bucket_bits_[rank / 64] |= uint64_t{1} << (rank % 64);
+
+    // cover the y1 values strictly inside (y1, y2)
+    int left = rank + 1 + leaf_size_;
+    int right = end_rank + leaf_size_;
+    for (; left < right; left >>= 1, right >>= 1) {
+        if (left & 1) insertTree(left++, id);
+        if (right & 1) insertTree(--right, id);
+    }
+    active_[id] = 1;
+}
+
+void OverlapSweep::insertTree(int node, int id) {
+    int entry = free_entry_;
+    if (entry != kNil) {
+        free_entry_ = entry_next_[entry];
+    } else {
+        entry = entry_box_.size();
+        entry_box_.push_back(0);
+        entry_next_.push_back(0);
+    }
+    entry_box_[entry] = id;
+    entry_next_[entry] = tree_head_[node];
+    tree_head_[node] = entry;
+}
+
+/*active boxes starting inside [y1, y2)*/
+template <typename Visitor>
+void OverlapSweep::queryBucket(int id, Visitor& visit) {
+    const auto [first, last] = rank_list_[id];
+    for (int word = first / 64; word * 64 < last; ++word) {
+        uint64_t bits = bucket_bits_[word];
+        if (word == first / 64)
+            bits &= ~uint64_t{0} << (first % 64);
+        while (bits) {
+            int rank = word * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (rank >= last) break;
+
+            int* link = &bucket_head_[rank];
+            while (*link != kNil) {
+                int other = *link;
+                if (!active_[other]) {
+                    *link = bucket_next_[other];  // unlink expired box
+                    continue;
+                }
+                visit(other, id);
+                link = &bucket_next_[other];
+            }
+            if (bucket_head_[rank] == kNil)
+                bucket_bits_[word] &= ~(uint64_t{1} << (rank % 64));
+        }
+    }
+}
+
+/*active boxes starting below y1 and covering y1*/
+template <typename Visitor>
+void OverlapSweep::queryTree(int id, Visitor& visit) {
+    for (int node = rank_list_[id].first + leaf_size_; node >= 1; node >>= 1) {
+        int* link = &tree_head_[node];
+        while (*link != kNil) {
+            int entry = *link;
+            int other = entry_box_[entry];
+            if (!active_[other]) {
+                // unlink expired box and recycle the entry
+                *link = entry_next_[entry];
+                entry_next_[entry] = free_entry_;
+                free_entry_ = entry;
+                continue;
+            }
+            visit(other, id);
+            link = &entry_next_[entry];
+        }
+    }
+}
+
+}  // namespace placement
+
+#endif  // SRC_PLACEMENT_OVERLAP_SWEEP_HPP_
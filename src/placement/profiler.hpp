@@ -0,0 +1,168 @@
+#ifndef SRC_PLACEMENT_PROFILER_HPP_
+#define SRC_PLACEMENT_PROFILER_HPP_
+
+#include <sys/resource.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <utility>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+namespace placement {
+
+/*Process-wide phase timers and counters, cheap enough to stay on.
+  hot loops count locally and add their total once, so the mutex is
+  only taken a handful of times per run. entries keep insertion order.*/
+class Profiler {
+ public:
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    void addTime(const std::string& phase, double seconds);
+    void add(const std::string& counter, long long value);
+    void setInfo(const std::string& key, const std::string& value);
+    void reset();
+
+    double time(const std::string& key) const;
+    long long counter(const std::string& key) const;
+    /*peak resident set size of the process in KiB*/
+    static long peakRssKb();
+
+    /*{"info": {...}, "phases": {name: seconds}, "counters": {...}, "peak_rss_kb": n}*/
+    std::string report() const;
+    bool writeReport(const std::string& path) const;
+
+ private:
+    Profiler() = default;
+
+    mutable std::mutex mutex_;
+    std::vector<std::pair<std::string, std::string>> info_list_;
+    std::vector<std::pair<std::string, double>> phase_list_;
+    std::vector<std::pair<std::string, long long>> counter_list_;
+
+    template <typename T>
+    static T& entry(std::vector<std::pair<std::string, T>>& list, const std::string& key);
+    static std::string quote(const std::string& text);
+};
+
+
+/*add the lifetime of the scope to a phase*/
+class ScopedTimer {
+ public:
+    explicit ScopedTimer(std::string phase)
+    : phase_(std::move(phase)), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start_;
+        Profiler::instance().addTime(phase_, duration.count());
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+ private:
+    std::string phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+
+template <typename T>
+T& Profiler::entry(std::vector<std::pair<std::string, T>>& list, const std::string& key) {
+    for (auto& [name, value] : list)
+        if (name == key)
+            return value;
+    list.emplace_back(key, T{});
+    return list.back().second;
+}
+
+void Profiler::addTime(const std::string& phase, double seconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry(phase_list_, phase) += seconds;
+}
+
+void Profiler::add(const std::string& counter, long long value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry(counter_list_, counter) += value;
+}
+
+void Profiler::setInfo(const std::string& key, const std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry(info_list_, key) = value;
+}
+
+void Profiler::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    info_list_.clear();
+    phase_list_.clear();
+    counter_list_.clear();
+}
+
+double Profiler::time(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [name, value] : phase_list_)
+        if (name == key)
+            return value;
+    return 0.0;
+}
+
+long long Profiler::counter(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [name, value] : counter_list_)
+        if (name == key)
+            return value;
+    return 0;
+}
+
+long Profiler::peakRssKb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return usage.ru_maxrss;  // KiB on Linux
+}
+
+std::string Profiler::quote(const std::string& text) {
+    std::string result = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        if (static_cast<unsigned char>(c) >= ' ')
+            result += c;
+    }
+    return result + '"';
+}
+
+std::string Profiler::report() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream out;
+    out << std::setprecision(6) << std::fixed;
+
+    out << "{\n  \"info\": {";
+    for (size_t i = 0; i < info_list_.size(); ++i)
+        out << (i ? ", " : "") << quote(info_list_[i].first) << ": " << quote(info_list_[i].second);
+    out << "},\n  \"phases\": {";
+    for (size_t i = 0; i < phase_list_.size(); ++i)
+        out << (i ? ", " : "") << quote(phase_list_[i].first) << ": " << phase_list_[i].second;
+    out << "},\n  \"counters\": {";
+    for (size_t i = 0; i < counter_list_.size(); ++i)
+        out << (i ? ", " : "") << quote(counter_list_[i].first) << ": " << counter_list_[i].second;
+    out << "},\n  \"peak_rss_kb\": " << peakRssKb() << "\n}\n";
+    return out.str();
+}
+
+bool Profiler::writeReport(const std::string& path) const {
+    std::ofstream out(path);
+    if (out.fail()) {
+        std::cerr << "cannot open " << path << std::endl;
+        return false;
+    }
+    out << report();
+    return out.good();
+}
+
+}  // namespace placement
+
+#endif  // SRC_PLACEMENT_PROFILER_HPP_
@@ -0,0 +1,120 @@
+#ifndef SRC_PLACEMENT_RADIX_SORT_HPP_
+#define SRC_PLACEMENT_RADIX_SORT_HPP_
+
+#include <array>
+
+#include <placement/system.hpp>
+#include <placement/thread_pool.hpp>
+
+namespace placement {
+
+using sort_item_type = std::pair<uint64_t, int>;  // (key, index)
+
+/*a key that orders (high, low) int pairs like the pairs themselves*/
+uint64_t sortKey(int high, int low = 0);
+
+/*Stable LSD radix sort of (key, index) pairs by key, 8 bits a pass.
+  one read counts every digit, passes whose digit is the same for all keys
+  are skipped, so small coordinates take a few passes. with a pool the
+  items are cut into chunks: a parallel count per pass, a prefix over
+  (digit, chunk), then a parallel scatter that keeps the order.*/
+void radixSort(std::vector<sort_item_type>& item_list, ThreadPool* pool = nullptr);
+
+/*cell ids by (x, width, id), sorted once and shared by the graph build
+  and the legalization. whoever moves or adds cells clears system.x_order*/
+const std::vector<int>& cellXOrder(backend::System& system, ThreadPool* pool = nullptr);
+
+
+uint64_t sortKey(int high, int low) {
+    // flipping the sign bit maps int order onto unsigned order
+    return (static_cast<uint64_t>(static_cast<uint32_t>(high) ^ 0x80000000u) << 32)
+         | (static_cast<uint32_t>(low) ^ 0x80000000u);
+}
+
+void radixSort(std::vector<sort_item_type>& item_list, ThreadPool* pool) {
+    constexpr int kPasses = 8;
+    constexpr int kBuckets = 256;
+    const int n = item_list.size();
+    if (n < 2) return;
+    const int num_chunks = pool && n >= 65536 ? pool->size() : 1;
+    auto forEach = [&](auto&& func) {
+        if (num_chunks > 1)
+            pool->parallelFor(0, num_chunks, func);
+        else
+            func(0);
+    };
+    auto chunkBegin = [&](int c) { return static_cast<long long>(n) * c / num_chunks; };
+    auto digitOf = [](const sort_item_type& item, int pass) -> int {
+        return (item.first >> (8*pass)) & 0xff;
+    };
+
+    /*every digit counted in one read, the counts do not depend on the order*/
+    using histogram_type = std::array<std::array<int, kBuckets>, kPasses>;
+    std::vector<histogram_type> total_list(num_chunks);
+    forEach([&](int c) {
+        auto& histogram = total_list[c];
+        for (auto& count : histogram) count.fill(0);
+        for (long long i = chunkBegin(c); i < chunkBegin(c + 1); ++i)
+            for (int pass = 0; pass < kPasses; ++pass)
+                histogram[pass][digitOf(item_list[i], pass)]++;
+    });
+
+    std::vector<sort_item_type> buffer(n);
+    std::vector<std::array<int, kBuckets>> count_list(num_chunks);
+    for (int pass = 0; pass < kPasses; ++pass) {
+        /*skip a digit every key shares*/
+        const int digit = digitOf(item_list[0], pass);
+        int same = 0;
+        for (int c = 0; c < num_chunks; ++c)
+            same += total_list[c][pass][digit];
+        if (same == n) continue;
+
+        // one chunk holds every item, so its total is the count in any order
+        forEach([&](int c) {
+            if (num_chunks == 1) {
+                count_list[c] = total_list[c][pass];
+                return;
+            }
+            count_list[c].fill(0);
+            for (long long i = chunkBegin(c); i < chunkBegin(c + 1); ++i)
+                count_list[c][digitOf(item_list[i], pass)]++;
+        });
+
+        /*bucket b of chunk c starts after every smaller bucket and after
+          bucket b of the earlier chunks, which keeps the sort stable*/
+        int offset = 0;
+        for (int b = 0; b < kBuckets; ++b) {
+            for (int c = 0; c < num_chunks; ++c) {
+                const int count = count_list[c][b];
+                count_list[c][b] = offset;
+                offset += count;
+            }
+        }
+        forEach([&](int c) {
+            auto& cursor = count_list[c];
+            for (long long i = chunkBegin(c); i < chunkBegin(c + 1); ++i)
+                buffer[cursor[digitOf(item_list[i], pass)]++] = item_list[i];
+        });
+        item_list.swap(buffer);
+    }
+}
+
+const std::vector<int>& cellXOrder(backend::System& system, ThreadPool* pool) {
+    const auto& cells = system.cells;
+    auto& x_order = system.x_order;
+    if (static_cast<int>(x_order.size()) == cells.size())
+        return x_order;
+
+    std::vector<sort_item_type> item_list(cells.size());
+    for (int i = 0; i < cells.size(); ++i)
+        item_list[i] = {sortKey(cells.x_list[i], cells.width_list[i]), i};
+    radixSort(item_list, pool);
+    x_order.resize(item_list.size());
+    for (size_t i = 0; i < item_list.size(); ++i)
+        x_order[i] = item_list[i].second;
+    return x_order;
+}
+
+}  // namespace placement
+
+#endif  // SRC_PLACEMENT_RADIX_SORT_HPP_
@@ -0,0 +1,280 @@
+#ifndef SRC_PLACEMENT_SNAPSHOT_HPP_
+#define SRC_PLACEMENT_SNAPSHOT_HPP_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <placement/system.hpp>
+#include <placement/output.hpp>
+
+namespace placement {
+
+/*Binary checkpoint of a System between pipeline stages: the parsed design,
+  the overlap graph and the partition if they exist, in the byte order of
+  the writing host (the version check rejects the other one):
+    header (64 bytes): "PLSS", uint32 version, uint32 flags, uint32 0,
+        int32 chip_width, chip_height, row_height, num_rows, num_terminals,
+        num_cells, max_cell_area, partition_cost, int64 total_cell_area,
+        uint64 name_bytes
+    names, uint32 name end offsets (terminals then cells),
+    terminal x, y, width, height, cell x, y, width, height (int32 arrays),
+    [kPartition] uint8 chip per cell,
+    [kGraph] uint64 num_neighbors, int32 offsets[num_cells + 1], int32 neighbors.
+  every array starts 8-byte aligned, so a load is a few bulk copies out of
+  the mapped file. the rows come back unblocked, like from Input.*/
+class Snapshot {
+ public:
+    using system_ptr_type = std::unique_ptr<backend::System>;
+
+    static constexpr uint32_t kGraph = 1;
+    static constexpr uint32_t kPartition = 2;
+
+    static bool write(const backend::System& system, const std::string& path);
+    /*throw std::invalid_argument on a truncated file or another version*/
+    static system_ptr_type read(const std::string& path);
+
+ private:
+    static constexpr char kMagic[4] = {'P', 'L', 'S', 'S'};
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kHeaderSize = 64;
+
+    static size_t padding(size_t offset) { return (8 - offset % 8) % 8; }
+};
+
+
+bool Snapshot::write(const backend::System& system, const std::string& path) {
+    BufferedWriter out(path);
+    if (!out.good()) {
+        std::cerr << "cannot open " << path << std::endl;
+        return false;
+    }
+
+    const auto& cells = system.cells;
+    const auto& graph = system.overlap_graph;
+    const int num_cells = cells.size();
+    const int num_terminals = system.terminal_list.size();
+    uint32_t flags = 0;
+    if (graph.numNodes() == num_cells)
+        flags |= kGraph;
+    if (static_cast<int>(system.left_cell_list.size() + system.right_cell_list.size()) == num_cells
+        && num_cells > 0)
+        flags |= kPartition;
+
+    /*names and their end offsets*/
+    std::string name_blob;
+    std::vector<uint32_t> name_end_list;
+    name_end_list.reserve(num_terminals + num_cells);
+    for (const auto& terminal : system.terminal_list) {
+        name_blob += terminal.name;
+        name_end_list.push_back(name_blob.size());
+    }
+    for (auto name : cells.name_list) {
+        name_blob += name;
+        name_end_list.push_back(name_blob.size());
+    }
+
+    size_t offset = 0;
+    auto put = [&](const void* data, size_t size) {
+        out.putBytes(data, size);
+        offset += size;
+    };
+    auto align = [&]() {
+        static const char zero[8] = {};
+        put(zero, padding(offset));
+    };
+    auto putArray = [&](const auto& list) {
+        put(list.data(), list.size() * sizeof(list[0]));
+        align();
+    };
+
+    const uint32_t header[3] = {kVersion, flags, 0};
+    put(kMagic, 4);
+    put(header, sizeof(header));
+    const int32_t scalar_list[8] = {system.chip_width, system.chip_height, system.row_height,
+                                    system.num_rows, num_terminals, num_cells,
+                                    system.max_cell_area, system.partition_cost};
+    put(scalar_list, sizeof(scalar_list));
+    const int64_t total_cell_area = system.total_cell_area;
+    const uint64_t name_bytes = name_blob.size();
+    put(&total_cell_area, 8);
+    put(&name_bytes, 8);
+
+    put(name_blob.data(), name_blob.size());
+    align();
+    putArray(name_end_list);
+
+    std::vector<int32_t> field_list(num_terminals);
+    for (auto field : {&backend::Terminal::x, &backend::Terminal::y,
+                       &backend::Terminal::width, &backend::Terminal::height}) {
+        for (int t = 0; t < num_terminals; ++t)
+            field_list[t] = system.terminal_list[t].*field;
+        putArray(field_list);
+    }
+    putArray(cells.x_list);
+    putArray(cells.y_list);
+    putArray(cells.width_list);
+    putArray(cells.height_list);
+
+    if (flags & kPartition)
+        putArray(cells.chip_list);
+    if (flags & kGraph) {
+        const uint64_t num_neighbors = graph.neighbor_list.size();
+        put(&num_neighbors, 8);
+        putArray(graph.offset_list);
+        putArray(graph.neighbor_list);
+    }
+    out.flush();
+    return out.good();
+}
+
+Snapshot::system_ptr_type Snapshot::read(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+        if (fd >= 0) ::close(fd);
+        std::cerr << "no such file!! " <<  std::endl;
+        return nullptr;
+    }
+    const size_t size = st.st_size;
+    if (size < kHeaderSize) {
+        ::close(fd);
+        throw std::invalid_argument("snapshot is truncated");
+    }
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "cannot map file!! " <<  std::endl;
+        return nullptr;
+    }
+    // unmapped on every way out
+    std::unique_ptr<void, std::function<void(void*)>> guard(mapped,
+        [size](void* data) { ::munmap(data, size); });
+    const char* data = static_cast<const char*>(mapped);
+
+    size_t offset = 0;
+    auto take = [&](size_t bytes) -> const char* {
+        if (bytes > size - offset)
+            throw std::invalid_argument("snapshot is truncated");
+        const char* first = data + offset;
+        offset += bytes;
+        return first;
+    };
+    auto align = [&]() { take(padding(offset)); };
+    auto readScalar = [&](auto& value) { std::memcpy(&value, take(sizeof(value)), sizeof(value)); };
+    auto readArray = [&](auto& list, size_t count) {
+        list.resize(count);
+        std::memcpy(list.data(), take(count * sizeof(list[0])), count * sizeof(list[0]));
+        align();
+    };
+
+    uint32_t version = 0, flags = 0, reserved = 0;
+    if (std::memcmp(take(4), kMagic, 4) != 0)
+        throw std::invalid_argument("not a snapshot");
+    readScalar(version);
+    readScalar(flags);
+    readScalar(reserved);
+    if (version != kVersion)
+        throw std::invalid_argument("snapshot version " + std::to_string(version)
+                                    + " is not supported");
+
+    auto system_ptr = std::make_unique<backend::System>();
+    auto& system = *system_ptr;
+    int32_t num_terminals = 0, num_cells = 0;
+    int64_t total_cell_area = 0;
+    uint64_t name_bytes = 0;
+    readScalar(system.chip_width);
+    readScalar(system.chip_height);
+    readScalar(system.row_height);
+    readScalar(system.num_rows);
+    readScalar(num_terminals);
+    readScalar(num_cells);
+    readScalar(system.max_cell_area);
+    readScalar(system.partition_cost);
+    readScalar(total_cell_area);
+    readScalar(name_bytes);
+    if (num_terminals < 0 || num_cells < 0 || system.num_rows < 0)
+        throw std::invalid_argument("snapshot is corrupted");
+    system.num_terminals = num_terminals;
+    system.num_cells = num_cells;
+    system.total_cell_area = total_cell_area;
+
+    system.row_list.reserve(system.num_rows);
+    for (int i = 0; i < system.num_rows; ++i)
+        system.row_list.push_back({0, system.row_height*i, system.chip_width, system.row_height});
+
+    /*names: one copy of the whole blob into the arena*/
+    const char* name_data = take(name_bytes);
+    align();
+    std::string_view name_blob = system.name_arena.intern(std::string_view(name_data, name_bytes));
+    std::vector<uint32_t> name_end_list;
+    readArray(name_end_list, static_cast<size_t>(num_terminals) + num_cells);
+    uint32_t name_begin = 0;
+    auto nextName = [&](int k) {
+        if (name_end_list[k] < name_begin || name_end_list[k] > name_bytes)
+            throw std::invalid_argument("snapshot is corrupted");
+        auto name = name_blob.substr(name_begin, name_end_list[k] - name_begin);
+        name_begin = name_end_list[k];
+        return name;
+    };
+
+    system.terminal_list.resize(num_terminals);
+    std::vector<int32_t> field_list;
+    for (auto field : {&backend::Terminal::x, &backend::Terminal::y,
+                       &backend::Terminal::width, &backend::Terminal::height}) {
+        readArray(field_list, num_terminals);
+        for (int t = 0; t < num_terminals; ++t)
+            system.terminal_list[t].*field = field_list[t];
+    }
+    for (int t = 0; t < num_terminals; ++t)
+        system.terminal_list[t].name = nextName(t);
+
+    auto& cells = system.cells;
+    cells.name_list.resize(num_cells);
+    for (int i = 0; i < num_cells; ++i)
+        cells.name_list[i] = nextName(num_terminals + i);
+    readArray(cells.x_list, num_cells);
+    readArray(cells.y_list, num_cells);
+    readArray(cells.width_list, num_cells);
+    readArray(cells.height_list, num_cells);
+    cells.area_list.resize(num_cells);
+    for (int i = 0; i < num_cells; ++i)
+        cells.area_list[i] = cells.width_list[i] * cells.height_list[i];
+    cells.final_x_list.assign(num_cells, 0);
+    cells.final_y_list.assign(num_cells, 0);
+
+    if (flags & kPartition) {
+        readArray(cells.chip_list, num_cells);
+        for (int i = 0; i < num_cells; ++i) {
+            if (cells.chip_list[i] > 1)
+                throw std::invalid_argument("snapshot partition is corrupted");
+            (cells.chip_list[i] == 0 ? system.left_cell_list : system.right_cell_list).push_back(i);
+        }
+    } else {
+        cells.chip_list.assign(num_cells, 0);
+    }
+
+    if (flags & kGraph) {
+        uint64_t num_neighbors = 0;
+        readScalar(num_neighbors);
+        auto& graph = system.overlap_graph;
+        readArray(graph.offset_list, static_cast<size_t>(num_cells) + 1);
+        readArray(graph.neighbor_list, num_neighbors);
+        if (graph.offset_list.front() != 0
+            || static_cast<uint64_t>(graph.offset_list.back()) != num_neighbors)
+            throw std::invalid_argument("snapshot graph is corrupted");
+        /*every later pass indexes by these without checking*/
+        for (int i = 0; i < num_cells; ++i)
+            if (graph.offset_list[i] > graph.offset_list[i + 1])
+                throw std::invalid_argument("snapshot graph is corrupted");
+        for (int neighbor : graph.neighbor_list)
+            if (neighbor < 0 || neighbor >= num_cells)
+                throw std::invalid_argument("snapshot graph is corrupted");
+    }
+    return system_ptr;
+}
+
+}  // namespace placement
+
+#endif  // SRC_PLACEMENT_SNAPSHOT_HPP_
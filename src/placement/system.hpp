@@ -10,6 +10,7 @@
 #include <queue>
 #include <map>
 #include <exception>
+#include <stdexcept>
 #include <cstring>
 #include <cstdlib>
 #include <functional>
@@ -17,28 +18,125 @@
 #include <algorithm>
 #include <random>
 #include <climits>
+#include <string_view>
+#include <memory_resource>
+#include <placement/csr_graph.hpp>
 namespace placement::backend {
 
+/*copies the cell and terminal names into a memory resource,
+  the views it hands out stay valid as long as the resource lives*/
+class NameArena {
+ public:
+    explicit NameArena(std::pmr::memory_resource* resource)
+    : resource_(resource) {}
+
+    std::string_view intern(std::string_view name) {
+        char* data = static_cast<char*>(resource_->allocate(name.size(), 1));
+        std::memcpy(data, name.data(), name.size());
+        return std::string_view(data, name.size());
+    }
+
+ private:
+    std::pmr::memory_resource* resource_;
+};
+
 // Graph
-struct Cell {
-    std::vector<std::shared_ptr<Cell>> adjacency_list;
-    std::shared_ptr<Cell> parent;
-    std::shared_ptr<Cell> next = NULL;
-    int gain;
-    std::string name;
-    int x = 0,  y = 0;  // left corner coordinate (glabol placement)
-    int width = 0;
-    int height = 0;
-    int area = 0;
-    int id;  // global cell id
-    int weight = 1;
+/*cells in struct-of-arrays form, a cell is its index in every list*/
+struct CellTable {
+    explicit CellTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    : name_list(resource), x_list(resource), y_list(resource), width_list(resource),
+      height_list(resource), area_list(resource), chip_list(resource),
+      final_x_list(resource), final_y_list(resource) {}
+
+    std::pmr::vector<std::string_view> name_list;  // owned by System::name_arena
+    std::pmr::vector<int> x_list, y_list;  // left corner coordinate (glabol placement)
+    std::pmr::vector<int> width_list;
+    std::pmr::vector<int> height_list;
+    std::pmr::vector<int> area_list;
+    std::pmr::vector<uint8_t> chip_list;  // 0: left, 1: right
+
+    std::pmr::vector<int> final_x_list, final_y_list;
+
+    int size() const { return static_cast<int>(x_list.size()); }
+
+    void reserve(int n) {
+        name_list.reserve(n);
+        x_list.reserve(n);
+        y_list.reserve(n);
+        width_list.reserve(n);
+        height_list.reserve(n);
+        area_list.reserve(n);
+        chip_list.reserve(n);
+        final_x_list.reserve(n);
+        final_y_list.reserve(n);
+    }
+
+    /*append a cell, return its id*/
+    int add(std::string_view name, int x, int y, int width, int height) {
+        name_list.push_back(name);
+        x_list.push_back(x);
+        y_list.push_back(y);
+        width_list.push_back(width);
+        height_list.push_back(height);
+        area_list.push_back(width*height);
+        chip_list.push_back(0);
+        final_x_list.push_back(0);
+        final_y_list.push_back(0);
+        return size() - 1;
+    }
+
+    /*keep cell i as cell remap[i] in the same order, drop it if remap[i] < 0*/
+    void compact(const std::vector<int>& remap) {
+        int n = 0;
+        for (int i = 0; i < size(); ++i) {
+            if (remap[i] < 0) continue;
+            name_list[n] = name_list[i];
+            x_list[n] = x_list[i];
+            y_list[n] = y_list[i];
+            width_list[n] = width_list[i];
+            height_list[n] = height_list[i];
+            area_list[n] = area_list[i];
+            chip_list[n] = chip_list[i];
+            final_x_list[n] = final_x_list[i];
+            final_y_list[n] = final_y_list[i];
+            n++;
+        }
+        name_list.resize(n);
+        x_list.resize(n);
+        y_list.resize(n);
+        width_list.resize(n);
+        height_list.resize(n);
+        area_list.resize(n);
+        chip_list.resize(n);
+        final_x_list.resize(n);
+        final_y_list.resize(n);
+    }
+};
+
+
+/*what legalization reads and writes of the cells*/
+struct LegalizeView {
+    explicit LegalizeView(CellTable& cells)
+    : x{cells.x_list.data()}, y{cells.y_list.data()}, width{cells.width_list.data()},
+      final_x{cells.final_x_list.data()}, final_y{cells.final_y_list.data()} {}
+
+    const int* x;
+    const int* y;
+    const int* width;
+    int* final_x;
+    int* final_y;
+};
+
 
-    int final_x = 0,  final_y = 0;
+// axis-aligned box, [x1, x2) x [y1, y2)
+struct Box {
+    int x1 = 0, y1 = 0;
+    int x2 = 0, y2 = 0;
 };
 
 
 struct Terminal {
-    std::string name;
+    std::string_view name;  // owned by System::name_arena
     int x = 0,  y = 0;  // left corner coordinate
     int width = 0;
     int height = 0;
@@ -49,25 +147,28 @@ struct Terminal {
    ACM International Symposium on Physical Design.*/
 
 // abacus dynamic program
+// its cells are order_list[begin .. end) of the subrow
 struct Cluster {
-    explicit Cluster(int x)
-    :xc{x}, ec{0}, qc{0}, wc{0} {}
+    Cluster(int x, int first)
+    :xc{x}, ec{0}, qc{0}, wc{0}, begin{first}, end{first} {}
     int xc;  // start x-position
-    int ec;  // ec = ec + e(i)
+    int ec;  // ec = ec + e(i), e(i) = 1
     int qc;  // qc = qc +e(i)[x'(i) -wc]
     int wc;  // wc = wc + w(i)
-
-    std::vector<std::shared_ptr<Cell>> cell_list;
-    void addCell(std::shared_ptr<Cell> c) {
-        cell_list.push_back(c);
-        ec += c->weight;
-        qc += c->weight * (c->x - wc);
-        wc += c->width;
+    int dc = 0;  // x displacement of its cells at xc
+    int begin, end;
+
+    // the cell was appended to order_list right after this cluster
+    void addCell(int x, int width) {
+        ++end;
+        ec += 1;
+        qc += x - wc;
+        wc += width;
     }
 
+    // the clusters are neighbors, merging only moves the end
     void addCluster(Cluster* cluster) {
-        for (const auto& cell : cluster->cell_list)
-            cell_list.push_back(cell);
+        end = cluster->end;
         ec += cluster->ec;
         qc += (cluster->qc - cluster->ec * wc);
         wc += cluster->wc;
@@ -75,34 +176,42 @@ struct Cluster {
 };
 
 
+// free span of a row between terminals, [x1, x2)
+struct Segment {
+    int x1 = 0, x2 = 0;
+    int y = 0;
+};
+
+
+// abacus state of one segment
 struct Subrow {
-    Subrow(int start_x, int width, int y)
-    : x1{start_x}, x2{start_x + width}, y{y} {
-        remain_space = x2 - x1;
+    explicit Subrow(const Segment& seg,
+                    std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    : segment{&seg}, order_list{resource}, cluster_list{resource} {
+        remain_space = seg.x2 - seg.x1;
         cost = 0;
         last_cluster_num = 0;
-        last_backup_num = 0;
+        num_collapses = 0;
     }
 
-    int x1, x2;
+    const Segment* segment;
     int remain_space;
-    int y;
-    int cost;
+    int cost;  // displacement of the placed cells
     int last_cluster_num;  // point to last Cluster in Clusters.
-    int last_backup_num;  // point to last Cluster in Backup
-    std::vector<Cluster> cluster_list;
-    std::vector<Cluster> cluster_backup_list;
-    int modifiedX(int x1, int x2, const std::shared_ptr<Cell>& cell) {
-        if (cell->x < x1) {
+    int num_collapses;  // clusters merged into their left neighbor so far
+    std::pmr::vector<int> order_list;  // placed cells from left to right
+    std::pmr::vector<Cluster> cluster_list;
+    int modifiedX(int x1, int x2, int x, int width) const {
+        if (x < x1) {
             return x1;
         }
-        if (cell->x + cell->width > x2) {
-            return x2 - cell->width;
+        if (x + width > x2) {
+            return x2 - width;
         }
-        return cell->x;
+        return x;
     }
 
-    bool isEmpty() {
+    bool isEmpty() const {
         return last_cluster_num == 0;
     }
 
@@ -113,16 +222,25 @@ struct Subrow {
         return cluster_list[last_cluster_num - 1];
     }
 
+    const Cluster& last() const {
+        if (isEmpty()) {
+            throw std::invalid_argument("cluster_list is empty");
+        }
+        return cluster_list[last_cluster_num - 1];
+    }
+
     void appendCluster(int x) {
+        const int first = order_list.size();
         if (cluster_list.size() == last_cluster_num)
-            cluster_list.push_back(Cluster(x));
+            cluster_list.push_back(Cluster(x, first));
         else if (cluster_list.size() > last_cluster_num)
-            cluster_list[last_cluster_num] = Cluster(x);
+            cluster_list[last_cluster_num] = Cluster(x, first);
 
         last_cluster_num++;
     }
 
     void collapse() {
+        const int x1 = segment->x1, x2 = segment->x2;
         int c = last_cluster_num - 1;
         for (; c >= 0; c--) {
             auto& cluster = cluster_list[c];
@@ -131,207 +249,131 @@ struct Subrow {
                 cluster.xc = x1;
             if (cluster.xc > x2 - cluster.wc)
                 cluster.xc = x2 - cluster.wc;
-            if (c > 0 && cluster_list[c-1].xc + cluster_list[c-1].wc > cluster.xc)
+            if (c > 0 && cluster_list[c-1].xc + cluster_list[c-1].wc > cluster.xc) {
                 cluster_list[c-1].addCluster(&cluster);
-            else
+                num_collapses++;
+            } else {
                 break;
+            }
         }
         last_cluster_num = c + 1;
     }
 
-    void place(const std::shared_ptr<Cell>& cell) {
-        int modify_x = modifiedX(x1, x2, cell);
-        if (isEmpty() || last().xc + last().wc <= modify_x) {
+    void place(int id, const LegalizeView& cells) {
+        int modify_x = modifiedX(segment->x1, segment->x2, cells.x[id], cells.width[id]);
+        bool separate = isEmpty() || last().xc + last().wc <= modify_x;
+        if (separate)
             appendCluster(modify_x);
-            last().addCell(cell);
-        } else {
-            last().addCell(cell);
+        order_list.push_back(id);
+        last().addCell(cells.x[id], cells.width[id]);
+        if (!separate)
             collapse();
-        }
-
-        // std::cout << cell->name <<" " << modify_x <<" " <<last_cluster_num  << " " << cost <<  std::endl;
-        // fgetc(stdin);
     }
 
-    int getPosition() {
-        int cost = 0;
-        for (int i = 0; i < last_cluster_num; ++i) {
-            const auto& cluster = cluster_list[i];
-            int x = cluster.xc;
-            for (auto& cell : cluster.cell_list) {
-                cell->final_x = x;
-                cell->final_y = y;
-                cost += std::abs(cell->final_x - cell->x);
-                cost += std::abs(cell->final_y - cell->y);
-                x += cell->width;
-            }
+    /*cost change of appending the cell, the subrow is left untouched.
+      only the tail clusters the cell would collapse are visited*/
+    int trialCost(int id, const LegalizeView& cells) const {
+        const int x1 = segment->x1, x2 = segment->x2;
+        const int cell_x = cells.x[id];
+        int modify_x = modifiedX(x1, x2, cell_x, cells.width[id]);
+        int cost = std::abs(segment->y - cells.y[id]);
+        if (isEmpty() || last().xc + last().wc <= modify_x)
+            return cost + std::abs(modify_x - cell_x);
+
+        // same steps as addCell() + collapse() on a merged aggregate
+        int c = last_cluster_num - 1;
+        int ec = cluster_list[c].ec + 1;
+        int qc = cluster_list[c].qc + (cell_x - cluster_list[c].wc);
+        int wc = cluster_list[c].wc + cells.width[id];
+        int old_cost = cluster_list[c].dc;
+        int xc;
+        for (;; --c) {
+            xc = qc / ec;
+            if (xc < x1)
+                xc = x1;
+            if (xc > x2 - wc)
+                xc = x2 - wc;
+            if (c == 0 || cluster_list[c-1].xc + cluster_list[c-1].wc <= xc)
+                break;
+            const auto& prev = cluster_list[c-1];
+            qc = prev.qc + qc - ec * prev.wc;
+            ec += prev.ec;
+            wc += prev.wc;
+            old_cost += prev.dc;
         }
-        return cost;
-    }
-
-    void backup() {
-        if (last_cluster_num > cluster_backup_list.size())
-            cluster_backup_list.push_back(cluster_list.back());
 
-        last_backup_num = last_cluster_num;
-        cluster_backup_list[last_backup_num - 1] = cluster_list[last_cluster_num - 1];
+        int x = xc;
+        for (int k = cluster_list[c].begin; k < last().end; ++k) {
+            int other = order_list[k];
+            cost += std::abs(x - cells.x[other]);
+            x += cells.width[other];
+        }
+        cost += std::abs(x - cell_x);
+        return cost - old_cost;
     }
 
-    void recoverClusterList() {
-        // std::cout << last_backup_num << " " << last_cluster_num << std::endl;
-        // fgetc(stdin);
-        if (last_cluster_num == last_backup_num) {
-            cluster_list[last_cluster_num - 1] = cluster_backup_list[last_cluster_num - 1];
-        } else if (last_cluster_num < last_backup_num) {
-            for (int i = last_cluster_num - 1; i < last_backup_num; ++i)
-                cluster_list[i] = cluster_backup_list[i];
+    /*append the cell, only the last cluster moves*/
+    void commit(int id, const LegalizeView& cells) {
+        int old_last = last_cluster_num - 1;
+        place(id, cells);
+        int old_cost = 0;
+        for (int i = last_cluster_num - 1; i <= old_last; ++i)
+            old_cost += cluster_list[i].dc;
+
+        auto& cluster = last();
+        int x = cluster.xc;
+        cluster.dc = 0;
+        for (int k = cluster.begin; k < cluster.end; ++k) {
+            int other = order_list[k];
+            cells.final_x[other] = x;
+            cells.final_y[other] = segment->y;
+            cluster.dc += std::abs(x - cells.x[other]);
+            x += cells.width[other];
         }
-        last_cluster_num = last_backup_num;
+        cost += cluster.dc - old_cost + std::abs(segment->y - cells.y[id]);
+        remain_space -= cells.width[id];
     }
-
 };
 
 
+// row geometry, the segments are cut by terminals and sorted by x
 struct Row {
     Row(int x, int y, int w, int h)
     :y{y}, height{h} {
-        subrow_list.emplace_back(x, w, y);
+        segment_list.push_back({x, x + w, y});
     }
 
     int y;
     int height;
-    std::vector<Subrow> subrow_list;
-    std::pair<Subrow*, int> placeRow(const std::shared_ptr<Cell>& cell);
-    void block(Terminal& terminal);
-
-    int calCost() {
-        int cost = 0;
-        for (auto& subrow : subrow_list) {
-            cost += subrow.getPosition();
-        }
-        return cost;
-    }
+    std::vector<Segment> segment_list;
 };
 
 /*system infomation*/
 struct System {
+    // per-run storage of names, terminals and cells, released with the System
+    std::pmr::monotonic_buffer_resource arena;
+
     int chip_width;
     int chip_height;
     int row_height;
     int num_rows;
     int num_terminals;
     int num_cells;
-    int total_cell_area;
+    long long total_cell_area;
     int max_cell_area;
-    std::vector<std::shared_ptr<Terminal>> terminal_list;
-    std::vector<std::shared_ptr<Cell>> cell_list;
-    std::vector<std::shared_ptr<Cell>> left_cell_list;
-    std::vector<std::shared_ptr<Cell>> right_cell_list;
+    NameArena name_arena{&arena};
+    std::pmr::vector<Terminal> terminal_list{&arena};
+    CellTable cells{&arena};
+    std::vector<int> left_cell_list;  // cell ids on each chip
+    std::vector<int> right_cell_list;
+    std::vector<int> x_order;  // cell ids by (x, width, id), see cellXOrder
     std::vector<Row> row_list;
+    bool rows_blocked = false;  // the terminals already cut row_list into segments
+    CsrGraph overlap_graph;  // cell id -> overlapping cell ids
     int partition_cost = 0;  // max cut
     int legalization_cost = 0;
 };
 
-// user need to enter terminal with the increasing x order.
-// the block function check the relative position between termianl node and place-row ,
-// and make the  correction : split the subrows or boundary correction.
-void Row::block(Terminal& terminal) {
-    // re-checking y range
-    if (terminal.y + terminal.height <= y  || terminal.y >= y + height) return;
-    Subrow* last_ptr = &(*subrow_list.rbegin());
-
-    int overlap_condition;
-    int t_x1 = terminal.x;
-    int t_x2 = t_x1 + terminal.width;
-    if ((t_x2 <= last_ptr->x1 )  || ( t_x1 >= last_ptr->x2) ) overlap_condition = 0;
-    else if (t_x1 <= last_ptr->x1  && t_x2 >= last_ptr->x2) overlap_condition = 1;
-    else if (t_x1 <= last_ptr->x1 && t_x2 < last_ptr->x2) overlap_condition = 2;
-    else if (t_x1 > last_ptr->x1 && t_x2 < last_ptr->x2) overlap_condition = 3;
-    else if (t_x1 > last_ptr->x1 && t_x2 >= last_ptr->x2) overlap_condition = 4;
-    if (overlap_condition == 1) {
-        subrow_list.pop_back();  // delete subrow
-    } else if (overlap_condition == 2) {
-        last_ptr->x1 = t_x2;
-    } else if (overlap_condition == 3) {
-        // split new subrow
-        subrow_list.push_back({t_x2, last_ptr->x2-t_x2, y});
-        last_ptr = &subrow_list[subrow_list.size() - 2];  // push back may allocate new memory
-        last_ptr->x2 = t_x1;
-    } else if (overlap_condition == 4) {
-        last_ptr->x2 = t_x1;
-    }
-
-
-    if (overlap_condition > 1)
-        last_ptr->remain_space = last_ptr->x2 - last_ptr->x1;
-}
-
-
-std::pair<Subrow*, int> Row::placeRow(const std::shared_ptr<Cell>& cell) {
-    Subrow* subrow = nullptr;
-    int best_cost = INT_MAX;
-    // binary Search Subrow
-    int left = 0;
-    int right = subrow_list.size()-1;
-    int start_id = std::max(0, left);
-    while (left < right) {
-        int mid = (left + right)/2;
-        if (subrow_list[mid].x1 == cell->x) {
-            start_id = mid;
-            break;
-        } else if (subrow_list[mid].x1 > cell->x) {
-            right = mid-1;
-        } else {
-            left = mid+1;
-        }
-    }
-
-    auto attempPlaceSubrow = [] (Subrow& subrow, std::shared_ptr<Cell> cell,
-    int& best_cost, Subrow* &best_subrow_place) ->bool {
-        if (subrow.remain_space >= cell->width) {
-            subrow.place(cell);
-            int after_cost = subrow.getPosition();
-            int delta_cost = after_cost - subrow.cost;
-
-            subrow.recoverClusterList();
-            if (delta_cost < best_cost) {
-                best_subrow_place = &subrow;
-                best_cost = delta_cost;
-                return true;
-            } else {
-                return false;
-            }
-        }
-        return true;
-    };
-
-    // std::cout << cell->name << " " << start_id << std::endl;
-    // fgetc(stdin);
-    for (int i = start_id - 1; i <= start_id + 1; ++i) {
-        if (i >= 0 && i < subrow_list.size()) {
-            attempPlaceSubrow(subrow_list[i], cell, best_cost, subrow);
-        }
-    }
-
-    for (int i = start_id - 2; i >= 0; --i) {
-        if (i >= 0)
-            if (!attempPlaceSubrow(subrow_list[i], cell, best_cost, subrow))
-                break;
-    }
-
-    for (int i = start_id + 2; i <subrow_list.size(); ++i) {
-        if (i < subrow_list.size())
-            if (!attempPlaceSubrow(subrow_list[i], cell, best_cost, subrow))
-                break;
-    }
-
-    // std::cout << subrow->x1 <<" " << subrow->x2 << " " << subrow->remain_space << std::endl;
-    // std::cout << best_cost << std::endl;
-    // fgetc(stdin);
-
-    return std::make_pair(subrow, best_cost);
-}
-
 }  // namespace placement::backend
 #endif  // SRC_PLACEMENT_SYSTEM_HPP_
 
@@ -0,0 +1,99 @@
+#ifndef SRC_PLACEMENT_THREAD_POOL_HPP_
+#define SRC_PLACEMENT_THREAD_POOL_HPP_
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <queue>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+namespace placement {
+
+/*Fixed size worker pool, tasks run in submission order*/
+class ThreadPool {
+ public:
+    explicit ThreadPool(int num_threads = defaultThreads()) {
+        num_threads = std::max(1, num_threads);
+        worker_list_.reserve(num_threads);
+        for (int i = 0; i < num_threads; ++i)
+            worker_list_.emplace_back([this] { work(); });
+    }
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        condition_.notify_all();
+        for (auto& worker : worker_list_)
+            worker.join();
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static int defaultThreads() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+    int size() const { return worker_list_.size(); }
+
+    template <typename Func>
+    auto submit(Func&& func) -> std::future<decltype(func())> {
+        using result_type = decltype(func());
+        auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<Func>(func));
+        auto future = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_queue_.emplace([task] { (*task)(); });
+        }
+        condition_.notify_one();
+        return future;
+    }
+
+    /*run func(i) for i in [begin, end) split into contiguous chunks, wait for all*/
+    template <typename Func>
+    void parallelFor(int begin, int end, Func&& func) {
+        int num_chunks = std::min(end - begin, size());
+        if (num_chunks <= 1) {
+            for (int i = begin; i < end; ++i) func(i);
+            return;
+        }
+        std::vector<std::future<void>> future_list;
+        future_list.reserve(num_chunks);
+        for (int c = 0; c < num_chunks; ++c) {
+            int first = begin + static_cast<long long>(end - begin) * c / num_chunks;
+            int last = begin + static_cast<long long>(end - begin) * (c + 1) / num_chunks;
+            future_list.push_back(submit([&func, first, last] {
+                for (int i = first; i < last; ++i) func(i);
+            }));
+        }
+        for (auto& future : future_list)
+            future.get();  // rethrows task exceptions
+    }
+
+ private:
+    std::vector<std::thread> worker_list_;
+    std::queue<std::function<void()>> task_queue_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stop_ = false;
+
+    void work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this] { return stop_ || !task_queue_.empty(); });
+                if (stop_ && task_queue_.empty()) return;
+                task = std::move(task_queue_.front());
+                task_queue_.pop();
+            }
+            task();
+        }
+    }
+};
+
+}  // namespace placement
+
+#endif  // SRC_PLACEMENT_THREAD_POOL_HPP_